@@ -0,0 +1,47 @@
+#include "bench_ast.hpp"
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+// triad_min.cpp's front end is in triad::mini, apart from triad-pro's. Its
+// say and echo write to the same triad::say_stream()/echo_stream(), so
+// Silence in triad_bench.cpp reaches both interpreters.
+#define TRIAD_MIN_NO_MAIN
+#include "../../triad_min.cpp"
+
+namespace triad::bench {
+
+  struct AstProgram::Impl {
+    std::string src;
+    mini::Context cx;
+  };
+
+  AstProgram::AstProgram(std::string_view src) : impl_(std::make_unique<Impl>()) {
+    impl_->src.assign(src);
+    mini::Parser p(mini::Lexer(impl_->src).tokenize(), impl_->src);
+    p.parseProgram(impl_->cx.functions, impl_->cx.capsules);
+  }
+
+  AstProgram::~AstProgram() = default;
+
+  void AstProgram::run() { mini::runCapsule(impl_->cx, "Main"); }
+
+  size_t ast_lex(std::string_view src) {
+    return mini::Lexer(src).tokenize().size();
+  }
+
+  size_t ast_parse(std::string_view src) {
+    mini::Context cx;
+    mini::Parser p(mini::Lexer(src).tokenize(), src);
+    p.parseProgram(cx.functions, cx.capsules);
+    return cx.functions.size() + cx.capsules.size();
+  }
+
+} // namespace triad::bench
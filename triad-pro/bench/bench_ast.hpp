@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+namespace triad::bench {
+
+  // The AST interpreter of triad_min.cpp, compiled in its own translation
+  // unit (bench_ast.cpp), which keeps its file-scope helpers out of
+  // triad_bench.cpp.
+  class AstProgram {
+  public:
+    // Lex and parse `src`; its capsule `Main` is what run() executes.
+    explicit AstProgram(std::string_view src);
+    ~AstProgram();
+    AstProgram(const AstProgram&) = delete;
+    AstProgram& operator=(const AstProgram&) = delete;
+
+    void run();
+
+  private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+  };
+
+  // Front-end stages alone, for the compile benchmarks; they return the
+  // number of tokens and of top-level definitions so the work is not elided.
+  size_t ast_lex(std::string_view src);
+  size_t ast_parse(std::string_view src);
+
+} // namespace triad::bench
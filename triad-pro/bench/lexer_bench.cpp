@@ -0,0 +1,141 @@
+// triad_lexer_bench: the lexer's hot paths against the versions they
+// replaced, on generated input.
+//   keywords: identifier classification, the perfect-hash Lexer::keyword()
+//             against the previous lowercase-and-compare chain.
+//   scan:     raw scanning (whitespace, comments, strings, identifiers) with
+//             the block scanners. Build with -DTRIAD_SCAN_SCALAR, default
+//             flags and TRIAD_NATIVE to compare the scalar, SSE2 and AVX2 paths.
+//   numbers:  numeric literal conversion, scan_number() against std::stod.
+#include "triad_lexer.hpp"
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace triad;
+
+namespace {
+
+  TokKind legacy_keyword(std::string_view id) {
+    std::string lowered;
+    lowered.reserve(id.size());
+    for (char c : id) lowered.push_back(std::tolower(static_cast<unsigned char>(c)));
+
+    if (lowered == "macro") return TokKind::KwMacro;
+    if (lowered == "end") return TokKind::KwEnd;
+    if (lowered == "struct") return TokKind::KwStruct;
+    if (lowered == "class") return TokKind::KwClass;
+    if (lowered == "enum") return TokKind::KwEnum;
+    if (lowered == "pure") return TokKind::KwPure;
+    if (lowered == "def") return TokKind::KwDef;
+    if (lowered == "try") return TokKind::KwTry;
+    if (lowered == "catch") return TokKind::KwCatch;
+    if (lowered == "finally") return TokKind::KwFinally;
+    if (lowered == "throw") return TokKind::KwThrow;
+    if (lowered == "if") return TokKind::KwIf;
+    if (lowered == "else") return TokKind::KwElse;
+    if (lowered == "for") return TokKind::KwFor;
+    if (lowered == "in") return TokKind::KwIn;
+    if (lowered == "loop") return TokKind::KwLoop;
+    if (lowered == "new") return TokKind::KwNew;
+    if (lowered == "and") return TokKind::KwAnd;
+    if (lowered == "or") return TokKind::KwOr;
+    if (lowered == "say") return TokKind::KwSay;
+    if (lowered == "echo") return TokKind::KwEcho;
+    if (lowered == "return") return TokKind::KwReturn;
+    return TokKind::Id;
+  }
+
+  template <class F>
+  double identifiers_per_second(const std::vector<std::string_view>& ids, int rounds, F classify, size_t& sink) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+      for (std::string_view id : ids) sink += static_cast<size_t>(classify(id));
+    std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+    return static_cast<double>(ids.size()) * rounds / dt.count();
+  }
+
+  bool bench_keywords() {
+    std::string src;
+    const char* line = "macro sparkle(level) say level if count > limit else Return total "
+                       "for item in items echo item.name End shine_2 = new Glow() and Or\n";
+    for (int i = 0; i < 20000; ++i) src += line;
+
+    std::vector<std::string_view> ids;
+    std::string_view view(src);
+    for (size_t i = 0; i < view.size();) {
+      if (!Lexer::isIdStart(view[i])) { ++i; continue; }
+      size_t start = i;
+      while (i < view.size() && Lexer::isIdChar(view[i])) ++i;
+      ids.push_back(view.substr(start, i - start));
+    }
+
+    size_t a = 0, b = 0;
+    double before = identifiers_per_second(ids, 20, legacy_keyword, a);
+    double after = identifiers_per_second(ids, 20, Lexer::keyword, b);
+    if (a != b) { std::cerr << "mismatch between keyword tables\n"; return false; }
+
+    std::cout << "keywords: " << ids.size() << " identifiers x 20 rounds\n"
+              << "  before (lowercase + compare): " << before / 1e6 << " M ids/s\n"
+              << "  after  (perfect hash):        " << after / 1e6 << " M ids/s\n";
+    return true;
+  }
+
+  void bench_scan() {
+    std::string gen;
+    for (int i = 0; i < 100000; ++i)
+      gen += "        /* node 1234: generated */ say \"value of the generated field\"  // trailing note\n"
+             "        result_identifier_long_name = other_identifier_name\n";
+
+    size_t tokens = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < 5; ++r) {
+      Lexer lx(gen);
+      while (true) {
+        lx.skipWhitespace();
+        char c = lx.peek();
+        if (!c) break;
+        if (Lexer::isIdStart(c)) lx.lexIdent();
+        else if (c == '"') lx.lexString();
+        else lx.get();
+        ++tokens;
+      }
+    }
+    std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+    std::cout << "scan: " << 5.0 * gen.size() / dt.count() / 1e6 << " MB/s (" << tokens / 5 << " tokens/pass)\n";
+  }
+
+  bool bench_numbers() {
+    std::string data;
+    for (int i = 0; i < 100000; ++i)
+      data += "[" + std::to_string(i * 7919) + ", 3.14159265, 2.5e-3, " + std::to_string(i) + ".75, 1e9]\n";
+    std::vector<std::string_view> nums;
+    for (size_t i = 0; i < data.size();) {
+      if (!std::isdigit(static_cast<unsigned char>(data[i]))) { ++i; continue; }
+      NumberLiteral lit = scan_number(data.data() + i, data.data() + data.size());
+      nums.push_back(std::string_view(data).substr(i, lit.len));
+      i += lit.len;
+    }
+    double sumOld = 0, sumNew = 0;
+    auto n0 = std::chrono::steady_clock::now();
+    for (std::string_view n : nums) sumOld += std::stod(std::string(n));
+    auto n1 = std::chrono::steady_clock::now();
+    for (std::string_view n : nums) sumNew += scan_number(n.data(), n.data() + n.size()).value;
+    auto n2 = std::chrono::steady_clock::now();
+    if (sumOld != sumNew) { std::cerr << "mismatch between number parsers\n"; return false; }
+    std::chrono::duration<double> dOld = n1 - n0, dNew = n2 - n1;
+    std::cout << "numbers: " << nums.size() << " numeric literals\n"
+              << "  before (std::stod):     " << nums.size() / dOld.count() / 1e6 << " M/s\n"
+              << "  after  (from_chars):    " << nums.size() / dNew.count() / 1e6 << " M/s\n";
+    return true;
+  }
+
+} // namespace
+
+int main() {
+  if (!bench_keywords()) return 1;
+  bench_scan();
+  return bench_numbers() ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+// triad_parser_bench: expression parsing throughput on expression-dense
+// input, precedence climbing (Parser::parseExpr) against the previous
+// one-function-per-level descent, kept here as LegacyExpr. Both must emit
+// the same code.
+#include "triad_parser.cpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace {
+
+struct LegacyExpr : triad::Parser {
+  using Parser::Parser;
+  using TokKind = triad::TokKind;
+  using Op = triad::Op;
+  void parseOr(){
+    parseAnd();
+    while (M(TokKind::KwOr)){
+      E(Op::SC_OR_BEGIN,0); int j=EJ(Op::SC_OR_EVAL); parseAnd();
+      int end = ch.emit(Op::SC_OR_END); ch.code[j].b = end;
+    }
+  }
+  void parseAnd(){
+    parseCmp();
+    while (M(TokKind::KwAnd)){
+      E(Op::SC_AND_BEGIN,0); int j=EJ(Op::SC_AND_EVAL); parseCmp();
+      int end = ch.emit(Op::SC_AND_END); ch.code[j].b = end;
+    }
+  }
+  void parseCmp(){
+    parseAdd();
+    while (P().kind==TokKind::EqEq||P().kind==TokKind::Ne||P().kind==TokKind::Lt||P().kind==TokKind::Le||P().kind==TokKind::Gt||P().kind==TokKind::Ge){
+      TokKind k=A().kind; parseAdd();
+      E(k==TokKind::EqEq?Op::EQ: k==TokKind::Ne?Op::NE: k==TokKind::Lt?Op::LT: k==TokKind::Le?Op::LE: k==TokKind::Gt?Op::GT:Op::GE);
+    }
+  }
+  void parseAdd(){
+    parseMul();
+    while (P().kind==TokKind::Plus || P().kind==TokKind::Minus){ TokKind k=A().kind; parseMul(); E(k==TokKind::Plus?Op::ADD:Op::SUB); }
+  }
+  void parseMul(){
+    parseUnary();
+    while (P().kind==TokKind::Star||P().kind==TokKind::Slash||P().kind==TokKind::Percent){
+      TokKind k=A().kind; parseUnary(); E(k==TokKind::Star?Op::MUL: k==TokKind::Slash?Op::DIV:Op::MOD);
+    }
+  }
+};
+
+// `say <expr>` lines only, so both parsers see the same statement shape.
+template <class P, class F>
+triad::Chunk parse_says(std::string_view src, F expr){
+  triad::TokenStream ts(src);
+  P p(ts);
+  while (p.P().kind != triad::TokKind::Eof){ p.A(); expr(p); p.E(triad::Op::SAY); }
+  return std::move(p.ch);
+}
+
+bool same_code(const triad::Chunk& a, const triad::Chunk& b){
+  if (a.code.size() != b.code.size()) return false;
+  for (size_t i = 0; i < a.code.size(); ++i)
+    if (a.code[i].op != b.code[i].op || a.code[i].a != b.code[i].a || a.code[i].b != b.code[i].b) return false;
+  return true;
+}
+
+} // namespace
+
+int main(){
+  using namespace triad;
+  std::string src;
+  const char* line = "say a + b * 3 - c / 2 % d < e * f + 1 and g == h or -i * (j + k) >= 4 and not_l != m - n * o\n";
+  for (int i = 0; i < 2000; ++i) src += line;
+
+  // Small input, many rounds, best of three: measures the parser rather than
+  // page faults from growing the chunk.
+  using clock = std::chrono::steady_clock;
+  constexpr int kRounds = 100;
+  Chunk before, after;
+  double bestOld = 1e9, bestNew = 1e9;
+  for (int trial = 0; trial < 3; ++trial){
+    auto t0 = clock::now();
+    for (int r = 0; r < kRounds; ++r) before = parse_says<LegacyExpr>(src, [](LegacyExpr& p){ p.parseOr(); });
+    auto t1 = clock::now();
+    for (int r = 0; r < kRounds; ++r) after = parse_says<Parser>(src, [](Parser& p){ p.parseExpr(); });
+    auto t2 = clock::now();
+    bestOld = std::min(bestOld, std::chrono::duration<double>(t1 - t0).count());
+    bestNew = std::min(bestNew, std::chrono::duration<double>(t2 - t1).count());
+  }
+  if (!same_code(before, after)){ std::cerr << "bytecode differs\n"; return 1; }
+
+  const double mb = kRounds * static_cast<double>(src.size()) / 1e6;
+  std::cout << src.size() / 1024 << " KiB of expressions (" << after.code.size() << " instructions) x " << kRounds << "\n"
+            << "  before (descent per level): " << mb / bestOld << " MB/s\n"
+            << "  after  (precedence table):  " << mb / bestNew << " MB/s\n";
+  return 0;
+}
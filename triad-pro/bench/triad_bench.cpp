@@ -0,0 +1,478 @@
+// triad_bench: microbenchmarks for the triad-pro VM, the AST interpreter of
+// triad_min.cpp and both front ends, with a regression gate against a saved
+// run. `triad_bench --help` lists the options.
+#include "triad_parser.cpp"
+#include "triad_vm.cpp"
+#include "triad_perf.hpp"
+#include "bench_ast.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace triad;
+
+namespace {
+
+  // One workload in each dialect. `@N` stands for the iteration count; a
+  // null source means the dialect has no way to say it (reported as n/a).
+  struct Case {
+    const char* name;
+    long iterations;
+    const char* ast; // capsule Main, triad_min.cpp
+    const char* vm;  // triad-pro
+  };
+
+  constexpr Case kCases[] = {
+    {"numeric_loop", 200000,
+     "capsule Main:\n  let i = 0\n  let s = 0\n  loop Again:\n    let s = s + i * 2\n    let i = i + 1\n"
+     "    jump Again if i < @N\n  end\n  say s\nend\n",
+     "s = 0\nfor i in 0..@N { s = s + i * 2 }\nsay s\n"},
+    {"register_mutate_loop", 200000,
+     "capsule Main:\n  Load R1 0\n  let i = 0\n  loop Again:\n    mutate R1 + 3\n    let i = i + 1\n"
+     "    jump Again if i < @N\n  end\nend\n",
+     nullptr},
+    {"string_concat", 100000,
+     "capsule Main:\n  let i = 0\n  loop Again:\n    let t = \"item \" + i + \" of \" + @N\n    let i = i + 1\n"
+     "    jump Again if i < @N\n  end\n  say t\nend\n",
+     "for i in 0..@N { t = \"item \" + i + \" of \" + @N }\nsay t\n"},
+    {"field_access", 200000,
+     nullptr,
+     "p = (3, 4)\ns = 0\nfor i in 0..@N { s = s + p[0] }\nsay s\n"},
+    {"macro_call", 100000,
+     "macro sq(x):\n  return x * x\nend\n\ncapsule Main:\n  let i = 0\n  let s = 0\n  loop Again:\n"
+     "    let s = s + sq(i)\n    let i = i + 1\n    jump Again if i < @N\n  end\n  say s\nend\n",
+     nullptr},
+    {"exception", 20000,
+     "capsule Main:\n  let i = 0\n  let s = 0\n  loop Again:\n    try:\n      throw i\n    catch e:\n"
+     "      let s = s + e\n    end\n    let i = i + 1\n    jump Again if i < @N\n  end\n  say s\nend\n",
+     nullptr},
+    {"tuple_construction", 200000,
+     nullptr,
+     "for i in 0..@N { t = (i, i + 1) }\nsay 0\n"},
+  };
+
+  // Front-end input: every workload of a dialect, repeated to this size.
+  constexpr size_t kCompileBytes = size_t(1) << 20;
+
+  struct Options {
+    std::string filter, engine, jsonOut, baseline;
+    int warmup = 2, reps = 10;
+    double scale = 1.0, maxRegression = 10.0;
+    bool hwCounters = false;
+  };
+
+  struct Result {
+    std::string name, engine, status = "ok", error;
+    std::vector<double> ns; // one per repetition, sorted
+    double median = 0, p95 = 0, min = 0;
+    HwReading hw;          // --hw-counters: mean per repetition
+    uint64_t executed = 0; // bytecode instructions per repetition (vm only)
+  };
+
+  // Program output during a benchmark goes nowhere: say and echo are
+  // discarded before they are buffered, anything else into a null streambuf.
+  class Silence {
+    struct NullBuf : std::streambuf {
+      int overflow(int c) override { return c; }
+    } null_;
+    std::streambuf* out_;
+    std::streambuf* err_;
+
+  public:
+    Silence() : out_(std::cout.rdbuf(&null_)), err_(std::cerr.rdbuf(&null_)) {
+      say_stream().set_discard(true);
+      echo_stream().set_discard(true);
+    }
+    ~Silence() {
+      say_stream().set_discard(false);
+      echo_stream().set_discard(false);
+      std::cout.rdbuf(out_);
+      std::cerr.rdbuf(err_);
+    }
+  };
+
+  std::string instantiate(std::string_view text, long n) {
+    std::string out;
+    const std::string count = std::to_string(n);
+    for (size_t at = 0;;) {
+      const size_t hit = text.find("@N", at);
+      out.append(text.substr(at, hit - at));
+      if (hit == std::string_view::npos) return out;
+      out += count;
+      at = hit + 2;
+    }
+  }
+
+  // Warm up, then time `reps` calls of `body`, reading `hw` around each if
+  // given. The first call that throws marks the pair unsupported: the engine
+  // lacks something the workload uses.
+  Result measure(const std::string& name, const std::string& engine, const Options& opt,
+                 const std::function<void()>& body, HwCounters* hw = nullptr) {
+    using clock = std::chrono::steady_clock;
+    Result r;
+    r.name = name;
+    r.engine = engine;
+    try {
+      Silence quiet;
+      for (int i = 0; i < opt.warmup; ++i) body();
+      for (int i = 0; i < opt.reps; ++i) {
+        if (hw) hw->start();
+        const auto t0 = clock::now();
+        body();
+        r.ns.push_back(std::chrono::duration<double, std::nano>(clock::now() - t0).count());
+        if (hw) r.hw += hw->stop();
+      }
+    } catch (const std::exception& e) {
+      r.status = "unsupported";
+      r.error = e.what();
+      r.ns.clear();
+      return r;
+    }
+    for (double& v : r.hw.value) v /= opt.reps;
+    std::sort(r.ns.begin(), r.ns.end());
+    if (!r.ns.empty()) {
+      const size_t n = r.ns.size();
+      r.min = r.ns.front();
+      r.median = n % 2 ? r.ns[n / 2] : (r.ns[n / 2 - 1] + r.ns[n / 2]) / 2;
+      r.p95 = r.ns[std::min(n - 1, size_t(std::ceil(0.95 * double(n))) - 1)];
+    }
+    return r;
+  }
+
+  Result not_applicable(const std::string& name, const std::string& engine) {
+    Result r;
+    r.name = name;
+    r.engine = engine;
+    r.status = "n/a";
+    return r;
+  }
+
+  bool selected(const Options& opt, const std::string& name, const std::string& engine) {
+    return (opt.filter.empty() || name.find(opt.filter) != std::string::npos) &&
+           (opt.engine.empty() || opt.engine == engine);
+  }
+
+  std::vector<Result> run_all(const Options& opt) {
+    std::vector<Result> out;
+    std::string astFront, vmFront;
+    std::optional<HwCounters> counters;
+    if (opt.hwCounters) {
+      counters.emplace();
+      if (!counters->any())
+        std::cerr << "[hw] hardware counters unavailable (" << counters->reason() << "); timing only\n";
+    }
+    HwCounters* hw = counters && counters->any() ? &*counters : nullptr;
+
+    for (const Case& c : kCases) {
+      const long n = std::max(1L, long(double(c.iterations) * opt.scale));
+      if (c.ast) astFront += instantiate(c.ast, n);
+      if (c.vm) vmFront += instantiate(c.vm, n);
+
+      if (selected(opt, c.name, "ast")) {
+        if (!c.ast) {
+          out.push_back(not_applicable(c.name, "ast"));
+        } else {
+          std::optional<bench::AstProgram> prog;
+          try {
+            prog.emplace(instantiate(c.ast, n));
+            out.push_back(measure(c.name, "ast", opt, [&] { prog->run(); }, hw));
+          } catch (const std::exception& e) {
+            out.push_back(not_applicable(c.name, "ast"));
+            out.back().status = "unsupported";
+            out.back().error = e.what();
+          }
+        }
+      }
+      if (selected(opt, c.name, "vm")) {
+        if (!c.vm) {
+          out.push_back(not_applicable(c.name, "vm"));
+        } else {
+          try {
+            const Chunk ch = parse_to_chunk(std::string_view(instantiate(c.vm, n)));
+            out.push_back(measure(c.name, "vm", opt, [&] {
+              VM vm;
+              vm.exec(ch);
+            }, hw));
+            if (hw && out.back().status == "ok") {
+              // One more, untimed run for the instruction count.
+              Silence quiet;
+              VM vm;
+              vm.tally_into(out.back().executed);
+              vm.exec(ch);
+            }
+          } catch (const std::exception& e) {
+            out.push_back(not_applicable(c.name, "vm"));
+            out.back().status = "unsupported";
+            out.back().error = e.what();
+          }
+        }
+      }
+    }
+
+    // Front ends: lexing alone, and the full compile to a runnable form.
+    const size_t bytes = std::max<size_t>(4096, size_t(double(kCompileBytes) * opt.scale));
+    const auto grow = [&](const std::string& unit) {
+      std::string s;
+      while (s.size() < bytes) s += unit;
+      return s;
+    };
+    const std::string astSrc = grow(astFront), vmSrc = grow(vmFront);
+    volatile size_t sink = 0; // keeps the front-end results alive
+    if (selected(opt, "lex", "ast")) out.push_back(measure("lex", "ast", opt, [&] { sink = bench::ast_lex(astSrc); }, hw));
+    if (selected(opt, "lex", "vm")) out.push_back(measure("lex", "vm", opt, [&] { sink = Lexer(vmSrc).run().size(); }, hw));
+    if (selected(opt, "parse", "ast"))
+      out.push_back(measure("parse", "ast", opt, [&] { sink = bench::ast_parse(astSrc); }, hw));
+    if (selected(opt, "parse", "vm"))
+      out.push_back(measure("parse", "vm", opt, [&] { sink = parse_to_chunk(std::string_view(vmSrc)).code.size(); }, hw));
+    return out;
+  }
+
+  std::string ms(double ns) {
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "%10.3f ms", ns / 1e6);
+    return buf;
+  }
+
+  void print_table(std::ostream& os, const std::vector<Result>& results) {
+    char line[160];
+    std::snprintf(line, sizeof line, "%-22s %-6s %13s %13s %13s\n", "benchmark", "engine", "median", "p95", "min");
+    os << line;
+    for (const Result& r : results) {
+      if (r.status == "ok") {
+        std::snprintf(line, sizeof line, "%-22s %-6s %13s %13s %13s\n", r.name.c_str(), r.engine.c_str(),
+                      ms(r.median).c_str(), ms(r.p95).c_str(), ms(r.min).c_str());
+        os << line;
+      } else {
+        std::snprintf(line, sizeof line, "%-22s %-6s   ", r.name.c_str(), r.engine.c_str());
+        os << line << r.status << (r.error.empty() ? "" : ": " + r.error) << "\n";
+      }
+    }
+  }
+
+  // --hw-counters: per bytecode instruction where the VM ran, else per
+  // repetition.
+  void print_hw_table(std::ostream& os, const std::vector<Result>& results) {
+    if (std::none_of(results.begin(), results.end(), [](const Result& r) { return r.hw.any(); })) return;
+    char line[200];
+    std::snprintf(line, sizeof line, "\n%-22s %-6s %-7s", "benchmark", "engine", "per");
+    os << line;
+    for (size_t i = 0; i < kHwEventCount; ++i) {
+      std::snprintf(line, sizeof line, " %13s", hw_event_name(HwEvent(i)));
+      os << line;
+    }
+    os << "\n";
+    for (const Result& r : results) {
+      if (r.status != "ok" || !r.hw.any()) continue;
+      const double per = r.executed ? double(r.executed) : 1.0;
+      std::snprintf(line, sizeof line, "%-22s %-6s %-7s", r.name.c_str(), r.engine.c_str(), r.executed ? "instr" : "run");
+      os << line;
+      for (size_t i = 0; i < kHwEventCount; ++i) {
+        if (r.hw.have[i]) std::snprintf(line, sizeof line, r.executed ? " %13.3f" : " %13.0f", r.hw.value[i] / per);
+        else std::snprintf(line, sizeof line, " %13s", "n/a");
+        os << line;
+      }
+      os << "\n";
+    }
+  }
+
+  std::string json_string(std::string_view s) {
+    std::string out = "\"";
+    for (char c : s) {
+      if (c == '"' || c == '\\') out += '\\';
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char buf[8];
+        std::snprintf(buf, sizeof buf, "\\u%04x", c);
+        out += buf;
+        continue;
+      }
+      out += c;
+    }
+    return out + "\"";
+  }
+
+  void write_json(std::ostream& os, const std::vector<Result>& results, const Options& opt) {
+    os << "{\n  \"version\": 1,\n  \"warmup\": " << opt.warmup << ",\n  \"reps\": " << opt.reps
+       << ",\n  \"scale\": " << opt.scale << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+      const Result& r = results[i];
+      os << "    {\"name\": " << json_string(r.name) << ", \"engine\": " << json_string(r.engine)
+         << ", \"status\": " << json_string(r.status);
+      if (r.status == "ok")
+        os << ", \"median_ns\": " << std::llround(r.median) << ", \"p95_ns\": " << std::llround(r.p95)
+           << ", \"min_ns\": " << std::llround(r.min);
+      if (r.executed) os << ", \"executed\": " << r.executed;
+      for (size_t h = 0; h < kHwEventCount; ++h)
+        if (r.hw.have[h]) os << ", \"hw_" << hw_event_name(HwEvent(h)) << "\": " << std::llround(r.hw.value[h]);
+      if (!r.error.empty()) os << ", \"error\": " << json_string(r.error);
+      os << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+  }
+
+  // Reads back what write_json wrote: every object with a name and an engine
+  // is a result. Only the fields the comparison needs are kept.
+  std::vector<Result> read_json(std::istream& is) {
+    const std::string text((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    std::vector<Result> out;
+    Result cur;
+    std::string key;
+    bool haveKey = false;
+    for (size_t i = 0; i < text.size(); ++i) {
+      const char c = text[i];
+      if (c == '{') {
+        cur = Result{};
+        cur.status.clear();
+      } else if (c == '}') {
+        if (!cur.name.empty() && !cur.engine.empty()) out.push_back(cur);
+        cur = Result{};
+      } else if (c == '"') {
+        std::string s;
+        for (++i; i < text.size() && text[i] != '"'; ++i) s += text[i] == '\\' && i + 1 < text.size() ? text[++i] : text[i];
+        size_t j = i + 1;
+        while (j < text.size() && (text[j] == ' ' || text[j] == '\n' || text[j] == '\r' || text[j] == '\t')) ++j;
+        if (j < text.size() && text[j] == ':') {
+          key = s;
+          haveKey = true;
+          i = j;
+        } else if (haveKey) {
+          if (key == "name") cur.name = s;
+          else if (key == "engine") cur.engine = s;
+          else if (key == "status") cur.status = s;
+          haveKey = false;
+        }
+      } else if (haveKey && (c == '-' || (c >= '0' && c <= '9'))) {
+        size_t used = 0;
+        const double v = std::stod(text.substr(i), &used);
+        if (key == "median_ns") cur.median = v;
+        else if (key == "p95_ns") cur.p95 = v;
+        else if (key == "min_ns") cur.min = v;
+        i += used - 1;
+        haveKey = false;
+      } else if (c == ',' || c == '[') {
+        haveKey = false;
+      }
+    }
+    return out;
+  }
+
+  // Medians against the baseline; false if any slowed down by more than
+  // the allowed percentage, or if a benchmark that ran in the baseline (and
+  // is selected by --filter/--engine) is missing or no longer runs.
+  bool compare(std::ostream& os, const std::vector<Result>& now, const std::vector<Result>& base, const Options& opt) {
+    bool ok = true;
+    char line[160];
+    std::snprintf(line, sizeof line, "\n%-22s %-6s %13s %13s %9s\n", "benchmark", "engine", "baseline", "now", "change");
+    os << line;
+    const auto find = [](const std::vector<Result>& in, const Result& r) {
+      return std::find_if(in.begin(), in.end(), [&](const Result& x) { return x.name == r.name && x.engine == r.engine; });
+    };
+    for (const Result& r : now) {
+      if (r.status != "ok") continue;
+      const auto b = find(base, r);
+      if (b == base.end() || b->status != "ok" || b->median <= 0) {
+        std::snprintf(line, sizeof line, "%-22s %-6s %13s %13s %9s\n", r.name.c_str(), r.engine.c_str(), "-",
+                      ms(r.median).c_str(), "new");
+        os << line;
+        continue;
+      }
+      const double change = (r.median - b->median) / b->median * 100.0;
+      const bool regressed = change > opt.maxRegression;
+      ok = ok && !regressed;
+      std::snprintf(line, sizeof line, "%-22s %-6s %13s %13s %+8.1f%%%s\n", r.name.c_str(), r.engine.c_str(),
+                    ms(b->median).c_str(), ms(r.median).c_str(), change, regressed ? "  REGRESSION" : "");
+      os << line;
+    }
+    for (const Result& b : base) {
+      if (b.status != "ok" || !selected(opt, b.name, b.engine)) continue;
+      const auto r = find(now, b);
+      if (r != now.end() && r->status == "ok") continue;
+      ok = false;
+      const std::string was = r == now.end() ? "missing" : r->status;
+      std::snprintf(line, sizeof line, "%-22s %-6s %13s %13s %9s  LOST\n", b.name.c_str(), b.engine.c_str(),
+                    ms(b.median).c_str(), was.c_str(), "-");
+      os << line;
+    }
+    return ok;
+  }
+
+  void usage() {
+    std::cout << "triad_bench: microbenchmarks for the triad-pro VM (vm) and the triad_min.cpp AST interpreter (ast)\n"
+              << "Usage: triad_bench [options]\n"
+              << "  --filter <s>         Only benchmarks whose name contains s\n"
+              << "  --engine <ast|vm>    Only one engine\n"
+              << "  --warmup <n>         Untimed runs first (default 2)\n"
+              << "  --reps <n>           Timed runs (default 10)\n"
+              << "  --scale <x>          Multiply iteration counts and front-end input size (default 1)\n"
+              << "  --json <file>        Write results as JSON (a baseline for --compare)\n"
+              << "  --compare <file>     Compare medians with a saved --json run\n"
+              << "  --max-regression <p> With --compare: fail if any median is more than p% slower (default 10)\n"
+              << "                       or a benchmark that ran in the baseline no longer does\n"
+              << "  --hw-counters        Also read cycles, instructions, branch/cache/TLB misses (perf_event_open),\n"
+              << "                       per bytecode instruction for vm, per run otherwise\n"
+              << "Benchmarks:";
+    for (const Case& c : kCases) std::cout << " " << c.name;
+    std::cout << " lex parse\n"
+              << "  lex: tokens only; parse: tokens to a runnable chunk / AST, ~1 MiB of the workloads above\n";
+  }
+
+} // namespace
+
+int main(int argc, char** argv) {
+  Options opt;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool more = i + 1 < argc;
+    if (arg == "--help" || arg == "-h") {
+      usage();
+      return 0;
+    } else if (arg == "--filter" && more) opt.filter = argv[++i];
+    else if (arg == "--engine" && more) opt.engine = argv[++i];
+    else if (arg == "--warmup" && more) opt.warmup = std::stoi(argv[++i]);
+    else if (arg == "--reps" && more) opt.reps = std::max(1, std::stoi(argv[++i]));
+    else if (arg == "--scale" && more) opt.scale = std::stod(argv[++i]);
+    else if (arg == "--json" && more) opt.jsonOut = argv[++i];
+    else if (arg == "--compare" && more) opt.baseline = argv[++i];
+    else if (arg == "--max-regression" && more) opt.maxRegression = std::stod(argv[++i]);
+    else if (arg == "--hw-counters") opt.hwCounters = true;
+    else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      return 2;
+    }
+  }
+
+  try {
+    std::vector<Result> base;
+    if (!opt.baseline.empty()) {
+      std::ifstream f(opt.baseline);
+      if (!f) throw std::runtime_error("Cannot open file: " + opt.baseline);
+      base = read_json(f);
+    }
+
+    const std::vector<Result> results = run_all(opt);
+    print_table(std::cout, results);
+    if (opt.hwCounters) print_hw_table(std::cout, results);
+    if (!opt.jsonOut.empty()) {
+      std::ofstream f(opt.jsonOut);
+      if (!f) throw std::runtime_error("Cannot write to: " + opt.jsonOut);
+      write_json(f, results, opt);
+    }
+    if (!opt.baseline.empty() && !compare(std::cout, results, base, opt)) {
+      std::cout << "FAILED: regression above " << opt.maxRegression << "% or a baseline benchmark lost\n";
+      return 1;
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -19,6 +19,7 @@ struct Chunk {
 #include <stdexcept>
 #include <sstream>
 #include "triad_bytecode.hpp"
+#include "triad_source.hpp"
 namespace triad {
     // Serialize a Chunk to a text stream (for debugging or simple persistence)
     inline void serialize_chunk(const Chunk& ch, std::ostream& os) {
@@ -88,13 +89,14 @@ namespace triad {
             std::cerr << "Usage: triad_serialize <input.triad> [output.chunk]\n";
             return 1;
         }
-        std::ifstream infile(argv[1]);
-        if (!infile) {
-            std::cerr << "Failed to open input file: " << argv[1] << "\n";
+        SourceBuffer src;
+        try {
+            src = SourceBuffer::open(argv[1]);
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to open input file: " << e.what() << "\n";
             return 1;
         }
-        std::string src((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
-        Lexer lexer(src);
+        Lexer lexer(src.view());
         auto tokens = lexer.run();
         Parser parser(std::move(tokens));
         Chunk chunk = parser.parse();
@@ -0,0 +1,237 @@
+#pragma once
+#include "triad_bytecode.hpp"
+#include "triad_lineindex.hpp"
+#include "triad_profile.hpp"
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+namespace triad {
+
+  namespace alloc_detail {
+
+    // Live blocks by address: linear probing over a malloc'd array with
+    // backward-shift deletion, so recording never calls operator new.
+    class PtrTable {
+    public:
+      struct Slot {
+        void* p;
+        uint32_t site;
+        uint64_t size;
+      };
+
+      PtrTable() noexcept = default;
+      PtrTable(const PtrTable&) = delete;
+      PtrTable& operator=(const PtrTable&) = delete;
+      ~PtrTable() { std::free(slots_); }
+
+      void clear() noexcept {
+        if (slots_) std::fill(slots_, slots_ + mask_ + 1, Slot{nullptr, 0, 0});
+        used_ = 0;
+      }
+
+      bool insert(void* p, uint32_t site, uint64_t size) noexcept {
+        if ((used_ + 1) * 2 > capacity() && !grow()) return false;
+        size_t i = hash(p) & mask_;
+        while (slots_[i].p) i = (i + 1) & mask_;
+        slots_[i] = {p, site, size};
+        ++used_;
+        return true;
+      }
+
+      bool erase(void* p, Slot& out) noexcept {
+        if (!slots_) return false;
+        size_t i = hash(p) & mask_;
+        for (; slots_[i].p != p; i = (i + 1) & mask_)
+          if (!slots_[i].p) return false;
+        out = slots_[i];
+        for (size_t j = i;;) {
+          j = (j + 1) & mask_;
+          if (!slots_[j].p) break;
+          const size_t k = hash(slots_[j].p) & mask_; // where slots_[j] wants to be
+          if (i <= j ? (i < k && k <= j) : (i < k || k <= j)) continue;
+          slots_[i] = slots_[j];
+          i = j;
+        }
+        slots_[i].p = nullptr;
+        --used_;
+        return true;
+      }
+
+    private:
+      Slot* slots_ = nullptr;
+      size_t mask_ = 0;
+      size_t used_ = 0;
+
+      [[nodiscard]] size_t capacity() const noexcept { return slots_ ? mask_ + 1 : 0; }
+
+      static size_t hash(const void* p) noexcept {
+        uint64_t x = uint64_t(reinterpret_cast<uintptr_t>(p)) >> 4;
+        x *= 0x9E3779B97F4A7C15ull;
+        return size_t(x ^ (x >> 32));
+      }
+
+      bool grow() noexcept {
+        const size_t cap = std::max<size_t>(1024, capacity() * 2);
+        Slot* fresh = static_cast<Slot*>(std::calloc(cap, sizeof(Slot)));
+        if (!fresh) return false;
+        Slot* old = slots_;
+        const size_t oldCap = capacity();
+        slots_ = fresh;
+        mask_ = cap - 1;
+        used_ = 0;
+        for (size_t i = 0; i < oldCap; ++i)
+          if (old[i].p) insert(old[i].p, old[i].site, old[i].size);
+        std::free(old);
+        return true;
+      }
+    };
+
+  } // namespace alloc_detail
+
+  // Allocations by the whole process while enabled (--time-phases), from
+  // triadc's operator new. Relaxed atomics: the pipelined compile allocates
+  // on several threads and only the totals matter.
+  struct AllocCounter {
+    static inline std::atomic<bool> enabled{false};
+    static inline std::atomic<uint64_t> count{0};
+    static inline std::atomic<uint64_t> bytes{0};
+
+    static void on_alloc(size_t n) noexcept {
+      if (!enabled.load(std::memory_order_relaxed)) return;
+      count.fetch_add(1, std::memory_order_relaxed);
+      bytes.fetch_add(n, std::memory_order_relaxed);
+    }
+  };
+
+  // triadc --profile=alloc. Heap allocations made while the VM runs, charged
+  // to the instruction it was executing (published by the VM, as for
+  // SampleProfiler): how many and how many bytes per instruction, and which
+  // of them are still live when the run ends. Fed by triadc's replacement
+  // operator new and delete (on_alloc/on_free), which return at once unless
+  // a profiler was started on the calling thread; the bookkeeping itself
+  // uses malloc and is not counted.
+  class AllocProfiler {
+  public:
+    volatile std::sig_atomic_t ip = -1; // written by the VM
+
+    explicit AllocProfiler(const Chunk& ch) : ch_(ch), sites_(ch.code.size() + 1) {}
+    ~AllocProfiler() { stop(); }
+
+    AllocProfiler(const AllocProfiler&) = delete;
+    AllocProfiler& operator=(const AllocProfiler&) = delete;
+
+    void start() noexcept {
+      live_.clear();
+      active_ = this;
+    }
+    void stop() noexcept {
+      if (active_ == this) active_ = nullptr;
+    }
+
+    static void on_alloc(void* p, size_t n) noexcept {
+      AllocProfiler* a = active_;
+      if (!a || !p) return;
+      const std::sig_atomic_t at = a->ip;
+      const size_t outside = a->sites_.size() - 1;
+      const size_t site = at >= 0 && size_t(at) < outside ? size_t(at) : outside;
+      Site& s = a->sites_[site];
+      ++s.count;
+      s.bytes += n;
+      if (a->live_.insert(p, uint32_t(site), n)) {
+        ++s.liveCount;
+        s.liveBytes += n;
+      }
+    }
+
+    static void on_free(void* p) noexcept {
+      AllocProfiler* a = active_;
+      alloc_detail::PtrTable::Slot was;
+      if (!a || !p || !a->live_.erase(p, was)) return;
+      --a->sites_[was.site].liveCount;
+      a->sites_[was.site].liveBytes -= was.size;
+    }
+
+    // The `top` instructions by bytes allocated and by bytes still live,
+    // with disassembly and source line, then totals per opcode. Call after
+    // stop().
+    void write_report(std::ostream& os, std::string_view src, size_t top = 20) const {
+      Site total;
+      for (const Site& s : sites_) {
+        total.count += s.count;
+        total.bytes += s.bytes;
+        total.liveCount += s.liveCount;
+        total.liveBytes += s.liveBytes;
+      }
+      os << "[alloc] " << total.count << " allocations, " << total.bytes << " bytes while the VM ran; "
+         << total.liveCount << " blocks, " << total.liveBytes << " bytes still live at the end\n";
+
+      const std::vector<uint32_t> offs = ch_.lines.expand(ch_.code.size());
+      const LineIndex index(src);
+      const auto table = [&](const char* title, uint64_t Site::*key) {
+        std::vector<size_t> hot;
+        for (size_t i = 0; i < sites_.size(); ++i)
+          if (sites_[i].*key) hot.push_back(i);
+        const size_t n = std::min(top, hot.size());
+        std::partial_sort(hot.begin(), hot.begin() + n, hot.end(), [&](size_t a, size_t b) {
+          return sites_[a].*key != sites_[b].*key ? sites_[a].*key > sites_[b].*key : a < b;
+        });
+        char line[96];
+        os << "\n" << title << ":\n";
+        std::snprintf(line, sizeof line, "%10s %14s %10s %14s %6s  %-27.27s ", "allocs", "bytes", "live", "live bytes", "ip",
+                      "instruction");
+        os << line << "source\n";
+        for (size_t i = 0; i < n; ++i) {
+          const size_t at = hot[i];
+          const Site& s = sites_[at];
+          const bool inVm = at < ch_.code.size();
+          std::snprintf(line, sizeof line, "%10llu %14llu %10llu %14llu %6s  %-27.27s ", (unsigned long long)s.count,
+                        (unsigned long long)s.bytes, (unsigned long long)s.liveCount, (unsigned long long)s.liveBytes,
+                        inVm ? std::to_string(at).c_str() : "-",
+                        inVm ? profile_detail::disasm(ch_, ch_.code[at]).c_str() : "(outside an instruction)");
+          os << line << (inVm ? profile_detail::frame(src, index, offs[at]) : "") << "\n";
+        }
+      };
+      table("Allocation sites by bytes", &Site::bytes);
+      if (total.liveBytes) table("Live at the end by bytes", &Site::liveBytes);
+
+      uint64_t count[kOpCount] = {}, bytes[kOpCount] = {};
+      for (size_t i = 0; i < ch_.code.size(); ++i) {
+        const size_t op = size_t(ch_.code[i].op);
+        if (op < kOpCount) {
+          count[op] += sites_[i].count;
+          bytes[op] += sites_[i].bytes;
+        }
+      }
+      std::vector<size_t> ops;
+      for (size_t op = 0; op < kOpCount; ++op)
+        if (count[op]) ops.push_back(op);
+      std::sort(ops.begin(), ops.end(), [&](size_t a, size_t b) { return bytes[a] != bytes[b] ? bytes[a] > bytes[b] : a < b; });
+      os << "\nBy opcode:\n";
+      for (size_t op : ops) {
+        char line[96];
+        std::snprintf(line, sizeof line, "  %-14s %10llu %14llu\n", op_name(Op(op)), (unsigned long long)count[op],
+                      (unsigned long long)bytes[op]);
+        os << line;
+      }
+    }
+
+  private:
+    struct Site {
+      uint64_t count = 0, bytes = 0;
+      uint64_t liveCount = 0, liveBytes = 0;
+    };
+
+    const Chunk& ch_;
+    std::vector<Site> sites_; // by ip; the last one is outside any instruction
+    alloc_detail::PtrTable live_;
+    static inline thread_local AllocProfiler* active_ = nullptr;
+  };
+
+} // namespace triad
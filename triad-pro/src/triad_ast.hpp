@@ -1,131 +1,15 @@
-#include "triad_vm.cpp"
-#include "triad_ast.hpp"
-#include <fstream>
-#include <sstream>
-#include <iostream>
-#include <filesystem>
-#include <string_view>
-#include <variant>
-#include <optional>
-
-using namespace triad;
-namespace fs = std::filesystem;
-using std::string_view;
-
-[[nodiscard]] static std::string slurp(const std::string& path) noexcept {
-  std::ifstream f(path);
-  if (!f) throw std::runtime_error("Cannot open file: " + path);
-  return std::string((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
-}
-
-static void emit_to_file(const std::string& code, const std::string& outPath) {
-  std::ofstream out(outPath);
-  if (!out) throw std::runtime_error("Cannot write to: " + outPath);
-  out << code;
-}
-
-static void run_vm(const Chunk& ch, bool trace = false) {
-  VM vm;
-  if (trace) vm.enable_trace(); // hypothetical hook
-  vm.exec(ch);
-}
-
-static void run_ast(const std::string& src) {
-  std::cout << "[AST interpreter not yet implemented]\n";
-}
-
-static void run_tests(bool verbose = false) {
-  for (const auto& entry : fs::directory_iterator("tests")) {
-    if (entry.path().extension() == ".triad") {
-      std::cout << "Running: " << entry.path().filename() << "\n";
-      std::string src = slurp(entry.path().string());
-      Chunk ch = parse_to_chunk(src);
-      if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-      run_vm(ch);
-    }
-  }
-}
-
-int main(int argc, char** argv) {
-  if (argc < 2) {
-    std::cout << "Triad Compiler CLI\n"
-              << "Usage: triadc <mode> <file.triad | dir> [options]\n"
-              << "Modes:\n"
-              << "  run-vm       Execute via VM\n"
-              << "  run-ast      Execute via AST interpreter\n"
-              << "  emit-nasm    Emit NASM assembly\n"
-              << "  emit-llvm    Emit LLVM IR\n"
-              << "  run-tests    Execute all .triad files in /tests\n"
-              << "Options:\n"
-              << "  -o <file>    Output to file\n"
-              << "  --verbose    Show debug info\n"
-              << "  --show-ast   Print AST\n"
-              << "  --show-bytecode Print bytecode\n"
-              << "  --trace-vm   Trace VM execution\n"
-              << "  --version    Show version\n";
-    return 0;
-  }
-
-  std::string mode = argv[1];
-  std::string target = argc > 2 ? argv[2] : "";
-  std::string outFile;
-  bool verbose = false, showAst = false, showBytecode = false, traceVm = false;
-
-  for (int i = 3; i < argc; ++i) {
-    std::string arg = argv[i];
-    if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-    else if (arg == "--verbose") verbose = true;
-    else if (arg == "--show-ast") showAst = true;
-    else if (arg == "--show-bytecode") showBytecode = true;
-    else if (arg == "--trace-vm") traceVm = true;
-    else if (arg == "--version") {
-      std::cout << "Triad Compiler v0.9.1\n";
-      return 0;
-    }
-  }
-
-  try {
-    if (mode == "run-tests") {
-      run_tests(verbose);
-      return 0;
-    }
-
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
-
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-      // ASTNode* ast = parse_to_ast(src); ast->dump();
-    }
-
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-      std::string asm_code = emit_nasm(ch); // stub
-      if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code;
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code;
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-}
-
-
+#pragma once
 // --- Additional: Minimal AST node structure and pretty-print utility ---
 
+#include "triad_limits.hpp"
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace triad {
 
 // Basic AST node kinds
@@ -146,6 +30,28 @@ enum class ASTKind {
   Unknown
 };
 
+// Every walk over the tree keeps its pending nodes on a heap stack, so a
+// tree nested as deep as generated code makes it costs memory linear in the
+// depth and never overflows the native stack.
+namespace ast_detail {
+
+// Pre-order, children left to right. visit(node, depth) returns whether to
+// enter the node's children.
+template <typename Node, typename Visit>
+void preorder(Node& root, Visit&& visit) {
+  std::vector<std::pair<Node*, int>> stack{{&root, 0}};
+  while (!stack.empty()) {
+    auto [node, depth] = stack.back();
+    stack.pop_back();
+    if (!visit(*node, depth)) continue;
+    for (auto it = node->children.rbegin(); it != node->children.rend(); ++it) {
+      if (*it) stack.emplace_back(it->get(), depth + 1);
+    }
+  }
+}
+
+} // namespace ast_detail
+
 // Minimal AST node structure
 struct ASTNode {
   ASTKind kind = ASTKind::Unknown;
@@ -154,20 +60,36 @@ struct ASTNode {
 
   ASTNode(ASTKind k, std::string v = {}) : kind(k), value(std::move(v)) {}
 
+  // Children are released from an explicit list rather than by nested
+  // unique_ptr destructors, one native frame per level.
+  ~ASTNode() {
+    std::vector<std::unique_ptr<ASTNode>> pending;
+    for (auto& child : children) {
+      if (child) pending.push_back(std::move(child));
+    }
+    while (!pending.empty()) {
+      std::unique_ptr<ASTNode> node = std::move(pending.back());
+      pending.pop_back();
+      for (auto& child : node->children) {
+        if (child) pending.push_back(std::move(child));
+      }
+    }
+  }
+
   // Add a child node
   void add_child(std::unique_ptr<ASTNode> child) {
     children.push_back(std::move(child));
   }
 
-  // Pretty-print the AST recursively
+  // Pretty-print the AST, one node per line indented by depth
   void dump(std::ostream& os = std::cout, int indent = 0) const {
-    for (int i = 0; i < indent; ++i) os << "  ";
-    os << ast_kind_name(kind);
-    if (!value.empty()) os << " (" << value << ")";
-    os << "\n";
-    for (const auto& child : children) {
-      if (child) child->dump(os, indent + 1);
-    }
+    ast_detail::preorder(*this, [&](const ASTNode& n, int depth) {
+      for (int i = 0; i < indent + depth; ++i) os << "  ";
+      os << ast_kind_name(n.kind);
+      if (!n.value.empty()) os << " (" << n.value << ")";
+      os << "\n";
+      return true;
+    });
   }
 
   static const char* ast_kind_name(ASTKind k) {
@@ -190,6 +112,8 @@ struct ASTNode {
   }
 };
 
+} // namespace triad
+
 // --- Additional: AST traversal and search utilities ---
 
 namespace triad {
@@ -197,26 +121,23 @@ namespace triad {
 // Visitor pattern for AST traversal
 template <typename Visitor>
 void traverse_ast(const ASTNode& node, Visitor&& visitor) {
-  visitor(node);
-  for (const auto& child : node.children) {
-    if (child) traverse_ast(*child, visitor);
-  }
+  ast_detail::preorder(node, [&](const ASTNode& n, int) {
+    visitor(n);
+    return true;
+  });
 }
 
 // Find all nodes of a given kind in the AST
 inline void find_nodes_by_kind(const ASTNode& node, ASTKind kind, std::vector<const ASTNode*>& out) {
-  if (node.kind == kind) out.push_back(&node);
-  for (const auto& child : node.children) {
-    if (child) find_nodes_by_kind(*child, kind, out);
-  }
+  traverse_ast(node, [&](const ASTNode& n) {
+    if (n.kind == kind) out.push_back(&n);
+  });
 }
 
 // Utility: Count total nodes in the AST
 inline size_t count_ast_nodes(const ASTNode& node) {
-  size_t count = 1;
-  for (const auto& child : node.children) {
-    if (child) count += count_ast_nodes(*child);
-  }
+  size_t count = 0;
+  traverse_ast(node, [&](const ASTNode&) { ++count; });
   return count;
 }
 
@@ -286,89 +207,126 @@ namespace triad {
 // Capsule-aware AST mutation: apply a mutator to all nodes, optionally skipping subtrees ("capsules")
 template <typename Mutator>
 void mutate_ast(ASTNode& node, Mutator&& mutator, bool capsule = false) {
-  if (capsule && (node.kind == ASTKind::Call || node.kind == ASTKind::Block)) {
+  ast_detail::preorder(node, [&](ASTNode& n, int) {
+    mutator(n);
     // Treat Call/Block as a capsule: do not mutate children
-    mutator(node);
-    return;
-  }
-  mutator(node);
-  for (auto& child : node.children) {
-    if (child) mutate_ast(*child, mutator, capsule);
-  }
+    return !(capsule && (n.kind == ASTKind::Call || n.kind == ASTKind::Block));
+  });
 }
 
 // Symbolic tracing: collect a trace of node kinds and values as a string
 inline void symbolic_trace(const ASTNode& node, std::ostream& os, int indent = 0) {
-  for (int i = 0; i < indent; ++i) os << "  ";
-  os << ASTNode::ast_kind_name(node.kind);
-  if (!node.value.empty()) os << " (" << node.value << ")";
-  os << "\n";
-  for (const auto& child : node.children) {
-    if (child) symbolic_trace(*child, os, indent + 1);
-  }
+  ast_detail::preorder(node, [&](const ASTNode& n, int depth) {
+    for (int i = 0; i < indent + depth; ++i) os << "  ";
+    os << ASTNode::ast_kind_name(n.kind);
+    if (!n.value.empty()) os << " (" << n.value << ")";
+    os << "\n";
+    return true;
+  });
 }
 
 // Optimization pass: constant folding for simple binary ops (e.g., Number + Number)
+inline bool fold_node(ASTNode& node) {
+  if (node.kind != ASTKind::BinaryOp || node.children.size() != 2) return false;
+  const ASTNode* lhs = node.children[0].get();
+  const ASTNode* rhs = node.children[1].get();
+  if (!lhs || !rhs || lhs->kind != ASTKind::Number || rhs->kind != ASTKind::Number) return false;
+  double a = std::stod(lhs->value);
+  double b = std::stod(rhs->value);
+  double result = 0.0;
+  if (node.value == "+") result = a + b;
+  else if (node.value == "-") result = a - b;
+  else if (node.value == "*") result = a * b;
+  else if (node.value == "/") result = b != 0.0 ? a / b : 0.0;
+  else return false;
+  node.kind = ASTKind::Number;
+  node.value = std::to_string(result);
+  node.children.clear();
+  return true;
+}
+
+// Folds bottom-up, so a chain of constant operations collapses in one pass.
 inline bool fold_constants(ASTNode& node) {
   bool changed = false;
-  for (auto& child : node.children) {
-    if (child) changed |= fold_constants(*child);
-  }
-  if (node.kind == ASTKind::BinaryOp && node.children.size() == 2) {
-    const ASTNode* lhs = node.children[0].get();
-    const ASTNode* rhs = node.children[1].get();
-    if (lhs && rhs && lhs->kind == ASTKind::Number && rhs->kind == ASTKind::Number) {
-      double a = std::stod(lhs->value);
-      double b = std::stod(rhs->value);
-      double result = 0.0;
-      if (node.value == "+") result = a + b;
-      else if (node.value == "-") result = a - b;
-      else if (node.value == "*") result = a * b;
-      else if (node.value == "/") result = b != 0.0 ? a / b : 0.0;
-      else return changed;
-      node.kind = ASTKind::Number;
-      node.value = std::to_string(result);
-      node.children.clear();
-      changed = true;
+  std::vector<std::pair<ASTNode*, bool>> stack{{&node, false}}; // (node, children done)
+  while (!stack.empty()) {
+    auto [n, done] = stack.back();
+    if (done) {
+      stack.pop_back();
+      changed |= fold_node(*n);
+      continue;
+    }
+    stack.back().second = true;
+    for (auto it = n->children.rbegin(); it != n->children.rend(); ++it) {
+      if (*it) stack.emplace_back(it->get(), false);
     }
   }
   return changed;
 }
 
 // Serialization: write AST to a stream in a simple text format
+//   <Kind> ["value"] <children>
+// one node per line, indented two spaces per level, children following in order.
 inline void serialize_ast(const ASTNode& node, std::ostream& os, int indent = 0) {
-  for (int i = 0; i < indent; ++i) os << "  ";
-  os << ASTNode::ast_kind_name(node.kind);
-  if (!node.value.empty()) os << " " << std::quoted(node.value);
-  os << " " << node.children.size() << "\n";
-  for (const auto& child : node.children) {
-    if (child) serialize_ast(*child, os, indent + 1);
-  }
+  ast_detail::preorder(node, [&](const ASTNode& n, int depth) {
+    size_t nchildren = 0;
+    for (const auto& child : n.children) nchildren += child != nullptr;
+    for (int i = 0; i < indent + depth; ++i) os << "  ";
+    os << ASTNode::ast_kind_name(n.kind);
+    if (!n.value.empty()) os << " " << std::quoted(n.value);
+    os << " " << nchildren << "\n";
+    return true;
+  });
 }
 
-// Deserialization: read AST from a stream (must match the format above)
-inline std::unique_ptr<ASTNode> deserialize_ast(std::istream& is, int indent = 0) {
-  std::string kind_str;
-  if (!(is >> std::ws)) return nullptr;
-  for (int i = 0; i < indent; ++i) is.ignore(2); // skip two spaces per indent
-  if (!(is >> kind_str)) return nullptr;
-  ASTKind kind = ASTKind::Unknown;
-  for (int k = 0; k <= static_cast<int>(ASTKind::Unknown); ++k) {
-    if (kind_str == ASTNode::ast_kind_name(static_cast<ASTKind>(k))) {
-      kind = static_cast<ASTKind>(k);
-      break;
+// Deserialization: read AST from a stream (must match the format above).
+// Nodes are attached through a stack of open parents; input nesting deeper
+// than `maxDepth` is rejected. Returns nullptr if no node could be read; a
+// truncated stream yields the nodes read before it ended.
+inline std::unique_ptr<ASTNode> deserialize_ast(std::istream& is, size_t maxDepth = kMaxNestingDepth) {
+  auto read_node = [&](size_t& nchildren) -> std::unique_ptr<ASTNode> {
+    std::string kind_str;
+    if (!(is >> kind_str)) return nullptr; // skips the indentation
+    ASTKind kind = ASTKind::Unknown;
+    for (int k = 0; k <= static_cast<int>(ASTKind::Unknown); ++k) {
+      if (kind_str == ASTNode::ast_kind_name(static_cast<ASTKind>(k))) {
+        kind = static_cast<ASTKind>(k);
+        break;
+      }
     }
-  }
-  std::string value;
-  if (is.peek() == ' ') is.get();
-  if (is.peek() == '"') is >> std::quoted(value);
+    std::string value;
+    if (is.peek() == ' ') is.get();
+    if (is.peek() == '"') is >> std::quoted(value);
+    nchildren = 0;
+    is >> nchildren;
+    return std::make_unique<ASTNode>(kind, value);
+  };
+
   size_t nchildren = 0;
-  is >> nchildren;
-  auto node = std::make_unique<ASTNode>(kind, value);
-  for (size_t i = 0; i < nchildren; ++i) {
-    node->add_child(deserialize_ast(is, indent + 1));
+  std::unique_ptr<ASTNode> root = read_node(nchildren);
+  if (!root) return nullptr;
+  struct Open {
+    ASTNode* node;
+    size_t left; // children still to read
+    size_t depth;
+  };
+  std::vector<Open> open;
+  if (nchildren > 0) open.push_back({root.get(), nchildren, 0});
+  while (!open.empty()) {
+    Open& top = open.back();
+    ASTNode* parent = top.node;
+    const size_t depth = top.depth + 1;
+    if (--top.left == 0) open.pop_back();
+    std::unique_ptr<ASTNode> child = read_node(nchildren);
+    if (!child) break;
+    if (depth > maxDepth) {
+      throw std::runtime_error("serialized AST nested deeper than " + std::to_string(maxDepth) + " levels");
+    }
+    ASTNode* c = child.get();
+    parent->add_child(std::move(child));
+    if (nchildren > 0) open.push_back({c, nchildren, depth});
   }
-  return node;
+  return root;
 }
 
 } // namespace triad
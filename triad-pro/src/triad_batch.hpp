@@ -0,0 +1,64 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+
+namespace triad {
+
+  // run-batch: how long each record took and how the batch went as a whole.
+  // Every record's time is kept (8 bytes each), so the percentiles are exact.
+  class BatchStats {
+  public:
+    void add(uint64_t nanos) { nanos_.push_back(nanos); }
+    void add_failed() noexcept { ++failed_; }
+    void add_bytes(uint64_t n) noexcept { bytes_ += n; }
+
+    // Fold in another worker's records.
+    void merge(const BatchStats& o) {
+      nanos_.insert(nanos_.end(), o.nanos_.begin(), o.nanos_.end());
+      failed_ += o.failed_;
+      bytes_ += o.bytes_;
+    }
+
+    [[nodiscard]] size_t records() const noexcept { return nanos_.size(); }
+    [[nodiscard]] uint64_t failed() const noexcept { return failed_; }
+
+    // Throughput over `seconds` of wall time on `jobs` threads, then the
+    // latency distribution of a single record (failed ones included).
+    void write_report(std::ostream& os, double seconds, unsigned jobs) {
+      std::sort(nanos_.begin(), nanos_.end());
+      uint64_t total = 0;
+      for (uint64_t n : nanos_) total += n;
+      const double secs = seconds > 0 ? seconds : 1e-9;
+      const std::ios::fmtflags flags = os.flags();
+      os << std::fixed << std::setprecision(3);
+      os << "[batch] " << nanos_.size() << " records";
+      if (failed_) os << " (" << failed_ << " failed)";
+      os << " in " << seconds << " s on " << jobs << " thread(s): " << std::setprecision(0) << nanos_.size() / secs
+         << " records/s, " << std::setprecision(1) << bytes_ / secs / (1 << 20) << " MiB/s of input\n";
+      if (!nanos_.empty()) {
+        os << std::setprecision(1) << "[batch] latency us: mean " << total / 1e3 / nanos_.size();
+        static constexpr struct { const char* name; double q; } kQuantiles[] = {
+          {"p50", 0.50}, {"p90", 0.90}, {"p99", 0.99}, {"p99.9", 0.999},
+        };
+        for (const auto& k : kQuantiles) os << "  " << k.name << " " << percentile(k.q) / 1e3;
+        os << "  max " << nanos_.back() / 1e3 << "\n";
+      }
+      os.flags(flags);
+    }
+
+  private:
+    std::vector<uint64_t> nanos_;
+    uint64_t failed_ = 0, bytes_ = 0;
+
+    // Nearest rank, on the sorted times.
+    [[nodiscard]] uint64_t percentile(double q) const noexcept {
+      const size_t rank = size_t(std::ceil(q * double(nanos_.size())));
+      return nanos_[std::min(nanos_.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+  };
+
+} // namespace triad
@@ -1,399 +1,149 @@
-#include "triad_ast.hpp"
-#include <fstream>
-#include <sstream>
+#pragma once
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
-#include <filesystem>
-#include <string_view>
-#include <variant>
-#include <optional>
+#include <vector>
+#include <string>
 
-using namespace triad;
-namespace fs = std::filesystem;
-using std::string_view;
+namespace triad {
 
-[[nodiscard]] static std::string slurp(const std::string& path) noexcept {
-  std::ifstream f(path);
-  if (!f) throw std::runtime_error("Cannot open file: " + path);
-  return std::string((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
-}
+enum class Op : uint8_t {
+  NOP,
+  PUSH_CONST, PUSH_VAR, SET_VAR,
+  ADD, SUB, MUL, DIV, MOD,
+  EQ, NE, LT, LE, GT, GE,
+  NOT, NEG,
+  GET_FIELD, CALL_METHOD, NEW_CLASS, MAKE_TUPLE,
+  IF_FALSE_JMP, JMP,
+  SAY, ECHO, RET,
+  // short-circuit
+  SC_AND_BEGIN, SC_AND_EVAL, SC_AND_END,
+  SC_OR_BEGIN,  SC_OR_EVAL,  SC_OR_END,
+  // for x in stdin / lines(path) / split(text, sep): ITER_OPEN a=slot
+  // b=IterSource; ITER_NEXT a=name of x, b=exit target, c=slot
+  ITER_OPEN, ITER_NEXT
+};
 
-static void emit_to_file(const std::string& code, const std::string& outPath) {
-  std::ofstream out(outPath);
-  if (!out) throw std::runtime_error("Cannot write to: " + outPath);
-  out << code;
-}
+inline constexpr size_t kOpCount = size_t(Op::ITER_NEXT) + 1;
 
-static void run_vm(const Chunk& ch, bool trace = false) {
-  VM vm;
-  if (trace) vm.enable_trace(); // hypothetical hook
-  vm.exec(ch);
-}
+// What ITER_OPEN reads; lines takes the path and split the text and the
+// separator ("" for whitespace) off the stack.
+enum IterSource { kIterStdin, kIterLines, kIterSplit };
 
-static void run_ast(const std::string& src) {
-  std::cout << "[AST interpreter not yet implemented]\n";
+inline const char* op_name(Op op){
+  static constexpr const char* kNames[kOpCount] = {
+    "NOP",
+    "PUSH_CONST", "PUSH_VAR", "SET_VAR",
+    "ADD", "SUB", "MUL", "DIV", "MOD",
+    "EQ", "NE", "LT", "LE", "GT", "GE",
+    "NOT", "NEG",
+    "GET_FIELD", "CALL_METHOD", "NEW_CLASS", "MAKE_TUPLE",
+    "IF_FALSE_JMP", "JMP",
+    "SAY", "ECHO", "RET",
+    "SC_AND_BEGIN", "SC_AND_EVAL", "SC_AND_END",
+    "SC_OR_BEGIN",  "SC_OR_EVAL",  "SC_OR_END",
+    "ITER_OPEN", "ITER_NEXT",
+  };
+  return size_t(op) < kOpCount ? kNames[size_t(op)] : "?";
 }
 
-static void run_tests(bool verbose = false) {
-  for (const auto& entry : fs::directory_iterator("tests")) {
-    if (entry.path().extension() == ".triad") {
-      std::cout << "Running: " << entry.path().filename() << "\n";
-      std::string src = slurp(entry.path().string());
-      Chunk ch = parse_to_chunk(src);
-      if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-      run_vm(ch);
-    }
-  }
-}
+struct Instr { Op op; int a=0,b=0,c=0; };
+struct Value { enum {Num,Str} tag=Num; double num=0; std::string str; static Value number(double d){ Value v; v.tag=Num; v.num=d; return v; } static Value string(std::string s){ Value v; v.tag=Str; v.str=std::move(s); return v; } };
 
-int main(int argc, char** argv) {
-  if (argc < 2) {
-    std::cout << "Triad Compiler CLI\n"
-              << "Usage: triadc <mode> <file.triad | dir> [options]\n"
-              << "Modes:\n"
-              << "  run-vm       Execute via VM\n"
-              << "  run-ast      Execute via AST interpreter\n"
-              << "  emit-nasm    Emit NASM assembly\n"
-              << "  emit-llvm    Emit LLVM IR\n"
-              << "  run-tests    Execute all .triad files in /tests\n"
-              << "Options:\n"
-              << "  -o <file>    Output to file\n"
-              << "  --verbose    Show debug info\n"
-              << "  --show-ast   Print AST\n"
-              << "  --show-bytecode Print bytecode\n"
-              << "  --trace-vm   Trace VM execution\n"
-              << "  --version    Show version\n";
-    return 0;
-  }
+// Where each run of instructions came from: the source byte offset of the
+// statement that emitted it. Runs are stored as (ip delta, offset delta)
+// varint pairs, two or three bytes per statement. Offsets, not lines, so the
+// parser never counts newlines; LineIndex resolves them when a profile or
+// diagnostic is printed.
+class LineTable {
+  std::vector<uint8_t> bytes_;
+  int ip_ = 0;          // last run written
+  uint32_t off_ = 0;
+  size_t runs_ = 0;
+  int markIp_ = -1;     // latest mark, written once code is emitted past it
+  uint32_t markOff_ = 0;
 
-  std::string mode = argv[1];
-  std::string target = argc > 2 ? argv[2] : "";
-  std::string outFile;
-  bool verbose = false, showAst = false, showBytecode = false, traceVm = false;
+  void put(uint64_t v){ while (v >= 0x80){ bytes_.push_back(uint8_t(v | 0x80)); v >>= 7; } bytes_.push_back(uint8_t(v)); }
+  static uint64_t get(const uint8_t*& p){ uint64_t v = 0; for (int s = 0;; s += 7){ v |= uint64_t(*p & 0x7f) << s; if (!(*p++ & 0x80)) return v; } }
 
-  for (int i = 3; i < argc; ++i) {
-    std::string arg = argv[i];
-    if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-    else if (arg == "--verbose") verbose = true;
-    else if (arg == "--show-ast") showAst = true;
-    else if (arg == "--show-bytecode") showBytecode = true;
-    else if (arg == "--trace-vm") traceVm = true;
-    else if (arg == "--version") {
-      std::cout << "Triad Compiler v0.9.1\n";
-      return 0;
+  void flush(){
+    if (markIp_ < 0) return;
+    if (runs_ == 0 || markOff_ != off_){
+      const int64_t d = int64_t(markOff_) - int64_t(off_);
+      put(uint64_t(markIp_ - ip_));
+      put((uint64_t(d) << 1) ^ uint64_t(d >> 63)); // zigzag
+      ip_ = markIp_; off_ = markOff_; ++runs_;
     }
+    markIp_ = -1;
   }
 
-  try {
-    if (mode == "run-tests") {
-      run_tests(verbose);
-      return 0;
-    }
+public:
+  static constexpr uint32_t kNone = UINT32_MAX;
 
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
+  // Code from `ip` on comes from source offset `off`. A later mark at the
+  // same ip replaces this one (a statement that emitted nothing).
+  void mark(int ip, uint32_t off){
+    if (markIp_ >= 0 && markIp_ != ip) flush();
+    markIp_ = ip; markOff_ = off;
+  }
 
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-      // ASTNode* ast = parse_to_ast(src); ast->dump();
+  // f(ip, off) for the start of every run, in ip order.
+  template <class F> void for_each(F&& f) const {
+    int ip = 0; int64_t off = 0;
+    for (const uint8_t* p = bytes_.data(), *end = p + bytes_.size(); p < end;){
+      ip += int(get(p));
+      const uint64_t z = get(p);
+      off += int64_t(z >> 1) ^ -int64_t(z & 1);
+      f(ip, uint32_t(off));
     }
+    if (markIp_ >= 0 && (runs_ == 0 || markOff_ != off_)) f(markIp_, markOff_);
+  }
 
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-      std::string asm_code = emit_nasm(ch); // stub
-      if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code;
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code;
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
+  // Offset for every ip below codeSize; kNone before the first mark.
+  [[nodiscard]] std::vector<uint32_t> expand(size_t codeSize) const {
+    std::vector<uint32_t> out(codeSize, kNone);
+    int at = 0; uint32_t cur = kNone;
+    for_each([&](int ip, uint32_t off){
+      for (; at < ip && at < (int)codeSize; ++at) out[at] = cur;
+      cur = off;
+    });
+    for (; at < (int)codeSize; ++at) out[at] = cur;
+    return out;
+  }
+
+  // Runs of `other`, its ips moved by `ipShift` and offsets by `offShift`
+  // (a unit linked after others, or compiled before an edit moved it).
+  void append(const LineTable& other, int ipShift, int64_t offShift = 0){
+    other.for_each([&](int ip, uint32_t off){ mark(ip + ipShift, uint32_t(int64_t(off) + offShift)); });
   }
 
-  return 0;
+  [[nodiscard]] size_t bytes() const noexcept { return bytes_.size(); }
+};
+
+struct Chunk {
+  std::vector<Instr> code;
+  std::vector<Value> consts;
+  std::vector<std::string> names;
+  LineTable lines;
+  int addConst(Value v){ consts.push_back(std::move(v)); return (int)consts.size()-1; }
+  int addName(const std::string& n){ names.push_back(n); return (int)names.size()-1; }
+  int emit(Op op,int a=0,int b=0,int c=0){ code.push_back({op,a,b,c}); return (int)code.size()-1; }
+};
+
+// FNV-1a over every instruction and the names they refer to: whether a saved
+// profile or trace was recorded from this code.
+[[nodiscard]] inline uint64_t code_fingerprint(const Chunk& ch) noexcept {
+  uint64_t h = 14695981039346656037ull;
+  const auto mix = [&](uint64_t v){ for (int i = 0; i < 8; ++i, v >>= 8) h = (h ^ (v & 0xff)) * 1099511628211ull; };
+  for (const Instr& in : ch.code){
+    mix(static_cast<uint64_t>(in.op));
+    mix(static_cast<uint32_t>(in.a));
+    mix(static_cast<uint32_t>(in.b));
+    mix(static_cast<uint32_t>(in.c));
+  }
+  for (const std::string& name : ch.names)
+    for (char c : name) mix(static_cast<unsigned char>(c));
+  return h;
 }
-      std::cerr << "Error: No input file specified.\n";
-       return 1;
-     }
-     std::string src = slurp(target);
-     Chunk ch = parse_to_chunk(src);
-     if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-     if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-     if (showAst) {
-       std::cout << "[AST dump not yet implemented]\n";
-       // ASTNode* ast = parse_to_ast(src); ast->dump();
-     }
-     if (mode == "run-vm") {
-       run_vm(ch, traceVm);
-     } else if (mode == "run-ast") {
-       run_ast(src);
-     } else if (mode == "emit-nasm") {
-         std::string asm_code = emit_nasm(ch); // stub
-         if (!outFile.empty()) emit_to_file(asm_code, outFile);
-       else std::cout << asm_code; // Print to stdout if no output file specified
-     } else if (mode == "emit-llvm") {
-       std::string llvm_code = emit_llvm(ch); // stub
-       if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-       else std::cout << llvm_code; // Print to stdout if no output file specified
-     } else {
-       std::cerr << "Unknown mode: " << mode << "\n";
-       return 1;
-     }
-   } catch (const std::exception& e) {
-     std::cerr << "Error: " << e.what() << "\n";
-     return 1;
-   }
-   return 0;
-   }
-   std::cout << "Triad Compiler v0.9.1\n";
-   std::string mode = argv[1];
-   std::string target = argc > 2 ? argv[2] : "";
-   std::string outFile;
-   bool verbose = false, showAst = false, showBytecode = false, traceVm
-       = false;
-   for (int i = 3; i < argc; ++i) {
-     std::string arg = argv[i];
-     if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-     else if (arg == "--verbose") verbose = true;
-	 else if (arg
-         == "--show-ast") showAst = true;
-     else if (arg == "--show-bytecode") showBytecode = true;
-     else if (arg == "--trace-vm") traceVm = true;
-     else if (arg == "--version") {
-       std::cout << "Triad Compiler v0.9.1\n";
-       return 0;
-     } else {
-       std::cerr << "Unknown argument: " << arg << "\n";
-       return 1;
-     }
-     }
-   try {
-     if (mode == "run-tests") {
-       run_tests(verbose);
-       return 0;
-     }
-     if (target.empty()) {
-       std::cerr << "Error: No input file specified.\n";
-       return 1;
-     }
-     std::string src = slurp(target);
-     Chunk ch = parse_to_chunk(src);
-     if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-     if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-     if (showAst) {
-       std::cout << "[AST dump not yet implemented]\n";
-       // ASTNode* ast = parse_to_ast(src); ast->dump();
-     }
-     if (mode == "run-vm") {
-       run_vm(ch, traceVm);
-     } else if (mode == "run-ast") {
-       run_ast(src);
-     } else if (mode == "emit-nasm") {
-         std::string asm_code = emit_nasm(ch); // stub
-         if (!outFile.empty()) emit_to_file(asm_code, outFile);
-       else std::cout << asm_code; // Print to stdout if no output file specified
-     } else if (mode == "emit-llvm") {
-       std::string llvm_code = emit_llvm(ch); // stub
-       if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-       else std::cout << llvm_code; // Print to stdout if no output file specified
-     } else {
-       std::cerr << "Unknown mode: " << mode << "\n";
-       return 1;
-     }
-   } catch (const std::exception& e) {
-     std::cerr << "Error: " << e.what() << "\n";
-     return 1;
-   }
-   return 0;
-   }
-   std::cout << "Triad Compiler v0.9.1\n";
-   std::string mode = argv[1];
-   std::string target = argc > 2 ? argv[2] : "";
-   std::string outFile;
-   bool verbose = false, showAst = false, showBytecode = false, traceVm
-	   = false;
-   for (int i = 3; i < argc; ++i) {
-     std::string arg = argv[i];
-     if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-     else if (arg == "--verbose") verbose = true;
-     else if (arg == "--show-ast") showAst = true;
-     else if (arg == "--show-bytecode") showBytecode = true;
-     else if (arg == "--trace-vm") traceVm = true;
-     else if (arg == "--version") {
-       std::cout << "Triad Compiler v0.9.1\n";
-       return 0;
-     } else {
-		 std::cerr << "Unknown argument: " << arg << "\n";
-		 return 1;
-         }
-   }
-   try {
-     if (mode == "run-tests") {
-       run_tests(verbose);
-       return 0;
-     }
-     if (target.empty()) {
-       std::cerr << "Error: No input file specified.\n";
-       return 1;
-     }
-     std::string src = slurp(target);
-     Chunk ch = parse_to_chunk(src);
-     if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-     if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-     if (showAst) {
-       std::cout << "[AST dump not yet implemented]\n";
-       // ASTNode* ast = parse_to_ast(src); ast->dump();
-     }
-     if (mode == "run-vm") {
-       run_vm(ch, traceVm);
-     } else if (mode == "run-ast") {
-       run_ast(src);
-     } else if (mode == "emit-nasm") {
-         std::string asm_code = emit_nasm(ch); // stub
-         if (!outFile.empty()) emit_to_file(asm_code, outFile);
-       else std::cout << asm_code; // Print to stdout if no output file specified
-     } else if (mode == "emit-llvm") {
-       std::string llvm_code = emit_llvm(ch); // stub
-       if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-       else std::cout << llvm_code; // Print to stdout if no output file specified
-     } else {
-       std::cerr << "Unknown mode: " << mode << "\n";
-       return 1;
-     }
-   } catch (const std::exception& e) {
-     std::cerr << "Error: " << e.what() << "\n";
-     return 1;
-   }
-   return 0;
-   }
-   std::cout << "Triad Compiler v0.9.1\n";
-   std::string mode = argv[1];
-   std::string target = argc > 2 ? argv[2] : "";
-   std::string outFile;
-   bool verbose = false, showAst = false, showBytecode = false, traceVm
-	   = false;
-   for (int i = 3; i < argc; ++i) {
-     std::string arg = argv[i];
-     if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-     else if (arg == "--verbose") verbose = true;
-     else if (arg == "--show-ast") showAst = true;
-     else if (arg == "--show-bytecode") showBytecode = true;
-     else if (arg == "--trace-vm") traceVm = true;
-     else if (arg == "--version") {
-       std::cout << "Triad Compiler v0.9.1\n";
-       return 0;
-	 }
-	 else {
-         std::cerr << "Unknown argument: " << arg << "\n";
-         return 1;
-         }
-   }
-   try {
-     if (mode == "run-tests") {
-       run_tests(verbose);
-       return 0;
-     }
-     if (target.empty()) {
-       std::cerr << "Error: No input file specified.\n";
-       return 1;
-     }
-     std::string src = slurp(target);
-     Chunk ch = parse_to_chunk(src);
-     if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-     if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-     if (showAst) {
-       std::cout << "[AST dump not yet implemented]\n";
-       // ASTNode* ast = parse_to_ast(src); ast->dump();
-     }
-     if (mode == "run-vm") {
-       run_vm(ch, traceVm);
-     } else if (mode == "run-ast") {
-       run_ast(src);
-     } else if (mode == "emit-nasm") {
-         std::string asm_code = emit_nasm(ch); // stub
-         if (!outFile.empty()) emit_to_file(asm_code, outFile);
-       else std::cout << asm_code; // Print to stdout if no output file specified
-     } else if (mode == "emit-llvm") {
-       std::string llvm_code = emit_llvm(ch); // stub
-       if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-       else std::cout << llvm_code; // Print to stdout if no output file specified
-     } else {
-       std::cerr << "Unknown mode: " << mode << "\n";
-       return 1;
-     }
-   } catch (const std::exception& e) {
-     std::cerr << "Error: " << e.what() << "\n";
-     return 1;
-   }
-   return 0;
-   }
-   std::cout << "Triad Compiler v0.9.1\n";
-   std::string mode = argv[1];
-   std::string target = argc > 2 ? argv[2] : "";
-   std::string outFile;
-   bool verbose = false, showAst = false, showBytecode = false, traceVm
-	   = false;
-   for (int i = 3; i < argc; ++i) {
-     std::string arg = argv[i];
-     if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-     else if (arg == "--verbose") verbose = true;
-     else if (arg == "--show-ast") showAst = true;
-     else if (arg == "--show-bytecode") showBytecode = true;
-     else if (arg == "--trace-vm") traceVm = true;
-     else if (arg == "--version") {
-       std::cout << "Triad Compiler v0.9.1\n";
-       return 0;
-     } else {
-		 std::cerr << "Unknown argument: " << arg << "\n";
-         return 1;
-         }
-   }
-   try {
-     if (mode == "run-tests") {
-       run_tests(verbose);
-       return 0;
-     }
-     if (target.empty()) {
-       std::cerr << "Error: No input file specified.\n";
-       return 1;
-     }
-     std::string src = slurp(target);
-     Chunk ch = parse_to_chunk(src);
-     if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-     if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-     if (showAst) {
-       std::cout << "[AST dump not yet implemented]\n";
-       // ASTNode* ast = parse_to_ast(src); ast->dump();
-     }
-     if (mode == "run-vm") {
-       run_vm(ch, traceVm);
-     } else if (mode == "run-ast") {
-       run_ast(src);
-     } else if (mode == "emit-nasm") {
-         std::string asm_code = emit_nasm(ch); // stub
-         if (!outFile.empty()) emit_to_file(asm_code, outFile);
-       else std::cout << asm_code; // Print to stdout if no output file specified
-     } else if (mode == "emit-llvm") {
-       std::string llvm_code = emit_llvm(ch); // stub
-       if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-       else std::cout << llvm_code; // Print to stdout if no output file specified
-     } else {
-       std::cerr << "Unknown mode: " << mode << "\n";
-       return 1;
-     }
-   } catch (const std::exception& e) {
-     std::cerr << "Error: " << e.what() << "\n";
-     return 1;
-   }
-   return 0;
-   }
+
+} // namespace triad
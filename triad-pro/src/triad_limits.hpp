@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+
+namespace triad {
+
+  // Deepest nesting the front end accepts: blocks, parentheses and argument
+  // lists when parsing, levels when reading a serialized AST. Parsing recurses
+  // once per level, so this bound is what keeps generated code from running
+  // the native stack out; past it the input is rejected with a diagnostic.
+  // triadc --max-depth overrides it.
+  inline constexpr size_t kMaxNestingDepth = 4096;
+
+  // Largest source the front end accepts, in memory or streamed. Tokens and
+  // the line index hold byte offsets in 32 bits; a longer input is rejected
+  // before an offset could wrap.
+  inline constexpr size_t kMaxSourceBytes = 0xffffffffu;
+
+} // namespace triad
@@ -0,0 +1,64 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "triad_scan.hpp"
+
+namespace triad {
+
+  // 1-based line and byte column.
+  struct LineCol {
+    int line = 1;
+    int col = 1;
+  };
+
+  // Start offset of every line in a source, collected in one vectorised pass
+  // over its '\n' bytes. Tokens only carry byte offsets; line/column is looked
+  // up here by binary search when a diagnostic, dump or debug table needs it.
+  class LineIndex {
+    std::vector<uint32_t> starts_;
+
+  public:
+    LineIndex() : starts_{0} {}
+
+    // With `loneCr`, a '\r' not followed by '\n' ends a line too, as in the
+    // root lexer, whose Eol is any of "\n", "\r\n" and "\r".
+    explicit LineIndex(std::string_view src, bool loneCr = false) : starts_{0} {
+      const char* begin = src.data();
+      const char* end = begin + src.size();
+      if (!loneCr) {
+        for (const char* p = begin; (p = scan::find(p, end, '\n')) < end;) {
+          ++p;
+          starts_.push_back(static_cast<uint32_t>(p - begin));
+        }
+        return;
+      }
+      for (const char* p = begin; (p = scan::find_either(p, end, '\n', '\r')) < end;) {
+        if (*p++ == '\r' && p < end && *p == '\n') ++p;
+        starts_.push_back(static_cast<uint32_t>(p - begin));
+      }
+    }
+
+    [[nodiscard]] LineCol at(uint32_t off) const noexcept {
+      auto it = std::upper_bound(starts_.begin(), starts_.end(), off);
+      const size_t line = static_cast<size_t>(it - starts_.begin());
+      return {static_cast<int>(line), static_cast<int>(off - starts_[line - 1]) + 1};
+    }
+
+    [[nodiscard]] size_t lines() const noexcept { return starts_.size(); }
+
+    // One-off lookup without building the table: counts the newlines before
+    // `off`. `from` is the position of src[0] when src is a window of a
+    // longer input.
+    [[nodiscard]] static LineCol locate(std::string_view src, size_t off, LineCol from = {}) noexcept {
+      const char* p = src.data();
+      const char* last = nullptr;
+      const size_t n = scan::count_newlines(p, p + off, &last);
+      if (n == 0) return {from.line, from.col + static_cast<int>(off)};
+      return {from.line + static_cast<int>(n), 1 + static_cast<int>(p + off - (last + 1))};
+    }
+  };
+
+} // namespace triad
@@ -0,0 +1,183 @@
+#pragma once
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace triad {
+
+  // `for line in stdin` and `for line in lines("file")`: the input one line
+  // at a time, read in 1 MiB blocks. A line is a view into the block, valid
+  // until the next call; memory stays at one block however long the input
+  // (more only for a line longer than a block).
+  class LineReader {
+  public:
+    static constexpr size_t kBlock = size_t(1) << 20;
+
+    LineReader() noexcept = default;
+    ~LineReader() { close(); }
+
+    LineReader(LineReader&& o) noexcept { *this = std::move(o); }
+    LineReader& operator=(LineReader&& o) noexcept {
+      if (this == &o) return *this;
+      close();
+      fd_ = std::exchange(o.fd_, -1);
+      owned_ = std::exchange(o.owned_, false);
+      eof_ = o.eof_;
+      buf_ = std::move(o.buf_);
+      cap_ = std::exchange(o.cap_, 0);
+      begin_ = std::exchange(o.begin_, 0);
+      end_ = std::exchange(o.end_, 0);
+      return *this;
+    }
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+
+    [[nodiscard]] static LineReader open(const std::string& path) {
+#if defined(_WIN32)
+      const int fd = ::_open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+      const int fd = ::open(path.c_str(), O_RDONLY);
+#endif
+      if (fd < 0) throw std::runtime_error("Cannot open file: " + path);
+#if defined(POSIX_FADV_SEQUENTIAL)
+      ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+      return LineReader(fd, true);
+    }
+
+    // Standard input; left open when the reader is done.
+    [[nodiscard]] static LineReader standard_input() { return LineReader(0, false); }
+
+    // The next line without its "\n" or "\r\n"; false at the end of input.
+    bool next(std::string_view& line) {
+      if (!buf_) return false;
+      size_t scanned = begin_; // bytes before this hold no newline
+      for (;;) {
+        if (const void* nl = std::memchr(buf_.get() + scanned, '\n', end_ - scanned)) {
+          const size_t at = size_t(static_cast<const char*>(nl) - buf_.get());
+          line = take(at);
+          begin_ = at + 1;
+          return true;
+        }
+        if (eof_) {
+          if (begin_ == end_) return false;
+          line = take(end_);
+          begin_ = end_;
+          return true;
+        }
+        // Keep the partial line, moved to the front, and read behind it.
+        const size_t partial = end_ - begin_;
+        if (begin_ > 0) std::memmove(buf_.get(), buf_.get() + begin_, partial);
+        begin_ = 0;
+        end_ = scanned = partial;
+        if (end_ == cap_) grow();
+        fill();
+      }
+    }
+
+  private:
+    int fd_ = -1;
+    bool owned_ = false;
+    bool eof_ = true;
+    std::unique_ptr<char[]> buf_;
+    size_t cap_ = 0, begin_ = 0, end_ = 0; // buf_[begin_, end_) is unread
+
+    LineReader(int fd, bool owned) : fd_(fd), owned_(owned), eof_(false), buf_(new char[kBlock]), cap_(kBlock) {}
+
+    std::string_view take(size_t end) const noexcept {
+      if (end > begin_ && buf_[end - 1] == '\r') --end;
+      return {buf_.get() + begin_, end - begin_};
+    }
+
+    void grow() {
+      std::unique_ptr<char[]> bigger(new char[cap_ * 2]);
+      std::memcpy(bigger.get(), buf_.get(), end_);
+      buf_ = std::move(bigger);
+      cap_ *= 2;
+    }
+
+    void fill() {
+      for (;;) {
+#if defined(_WIN32)
+        const int n = ::_read(fd_, buf_.get() + end_, unsigned(cap_ - end_));
+#else
+        const ssize_t n = ::read(fd_, buf_.get() + end_, cap_ - end_);
+#endif
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) throw std::runtime_error(std::string("Cannot read input: ") + std::strerror(errno));
+        if (n == 0) eof_ = true;
+        end_ += size_t(n);
+        return;
+      }
+    }
+
+    void close() noexcept {
+      if (!owned_ || fd_ < 0) return;
+#if defined(_WIN32)
+      ::_close(fd_);
+#else
+      ::close(fd_);
+#endif
+      fd_ = -1;
+    }
+  };
+
+  // `for field in split(text, sep)`: the parts of `text` between occurrences
+  // of `sep`, or, with no separator, the runs of characters other than spaces
+  // and tabs (as awk splits a record). Fields are views into the splitter's
+  // own copy of the text.
+  class FieldSplitter {
+  public:
+    void reset(std::string_view text, std::string_view sep) {
+      text_.assign(text);
+      sep_.assign(sep);
+      pos_ = 0;
+      done_ = false;
+    }
+
+    bool next(std::string_view& field) {
+      const std::string_view t = text_;
+      if (sep_.empty()) {
+        while (pos_ < t.size() && (t[pos_] == ' ' || t[pos_] == '\t')) ++pos_;
+        if (pos_ == t.size()) return false;
+        const size_t start = pos_;
+        while (pos_ < t.size() && t[pos_] != ' ' && t[pos_] != '\t') ++pos_;
+        field = t.substr(start, pos_ - start);
+        return true;
+      }
+      if (done_) return false;
+      size_t end;
+      if (sep_.size() == 1) {
+        const void* hit = std::memchr(t.data() + pos_, sep_[0], t.size() - pos_);
+        end = hit ? size_t(static_cast<const char*>(hit) - t.data()) : std::string_view::npos;
+      } else {
+        end = t.find(sep_, pos_);
+      }
+      if (end == std::string_view::npos) {
+        end = t.size();
+        done_ = true;
+      }
+      field = t.substr(pos_, end - pos_);
+      pos_ = end + sep_.size();
+      return true;
+    }
+
+  private:
+    std::string text_, sep_;
+    size_t pos_ = 0;
+    bool done_ = true;
+  };
+
+} // namespace triad
@@ -0,0 +1,109 @@
+#pragma once
+#include "triad_bytecode.hpp"
+#include "triad_pgo.hpp"
+#include "triad_profile.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace triad {
+
+  // triadc analyze --ngrams. Opcode sequences of 2..N instructions that a
+  // superinstruction could replace: consecutive instructions of one basic
+  // block, so a jump may end one and a jump target only start one. Each is
+  // counted once per place in the code and, for programs given an
+  // instrumented run, once per execution. Inside a block only the previous
+  // instruction leads to the next, so a sequence ran as often as its last
+  // instruction did.
+  class NgramStats {
+  public:
+    static constexpr size_t kMaxN = 8; // opcodes packed a byte each
+
+    explicit NgramStats(size_t maxN) : maxN_(std::clamp<size_t>(maxN, 2, kMaxN)), grams_(maxN_ + 1) {}
+
+    // `counts`: exec_counts from a counted run of `ch`, or null.
+    void add(const Chunk& ch, const ProfileData* counts) {
+      ++programs_;
+      instructions_ += ch.code.size();
+      if (counts) {
+        ++runs_;
+        dispatched_ += counts->total();
+      }
+      const auto executed = [&](size_t ip) -> uint64_t {
+        return counts && ip < counts->exec_counts.size() ? counts->exec_counts[ip] : 0;
+      };
+      std::vector<int> starts = pgo_detail::leaders(ch);
+      if (starts.empty()) starts = {0, int(ch.code.size())}; // a jump leaves the code: treat it as one block
+      for (size_t b = 0; b + 1 < starts.size(); ++b) {
+        const size_t first = size_t(starts[b]), end = size_t(starts[b + 1]);
+        for (size_t ip = first; ip < end; ++ip) {
+          uint64_t key = 0;
+          for (size_t n = 1; n <= maxN_ && ip + n <= end; ++n) {
+            key = key << 8 | (uint64_t(ch.code[ip + n - 1].op) + 1);
+            if (n < 2) continue;
+            Count& c = grams_[n][key];
+            ++c.sites;
+            c.executed += executed(ip + n - 1);
+          }
+        }
+      }
+    }
+
+    // For each length, the `top` sequences, by executions when any program
+    // ran, else by places in the code. Fusing a sequence of n saves n - 1
+    // dispatches each time it runs; savings of different rows overlap.
+    void write_report(std::ostream& os, size_t top = 20) const {
+      const bool dynamic = runs_ > 0;
+      char line[160];
+      os << "[ngrams] " << programs_ << " programs, " << instructions_ << " instructions";
+      if (dynamic) os << "; " << runs_ << " executed, " << dispatched_ << " instructions dispatched";
+      os << "\n";
+      for (size_t n = 2; n <= maxN_; ++n) {
+        std::vector<std::pair<uint64_t, Count>> rows(grams_[n].begin(), grams_[n].end());
+        if (rows.empty()) continue;
+        const size_t k = std::min(top, rows.size());
+        std::partial_sort(rows.begin(), rows.begin() + k, rows.end(), [&](const auto& a, const auto& b) {
+          if (dynamic && a.second.executed != b.second.executed) return a.second.executed > b.second.executed;
+          if (a.second.sites != b.second.sites) return a.second.sites > b.second.sites;
+          return a.first < b.first;
+        });
+        os << "\n" << n << "-grams (" << rows.size() << " distinct):\n";
+        std::snprintf(line, sizeof line, "%5s %14s %9s %8s  %s\n", "rank", "executed", "saves", "sites", "sequence");
+        os << line;
+        for (size_t i = 0; i < k; ++i) {
+          const Count& c = rows[i].second;
+          char saves[16] = "-";
+          if (dynamic && dispatched_)
+            std::snprintf(saves, sizeof saves, "%.2f%%", 100.0 * double(c.executed * (n - 1)) / double(dispatched_));
+          std::snprintf(line, sizeof line, "%5zu %14s %9s %8llu  ", i + 1,
+                        dynamic ? std::to_string(c.executed).c_str() : "-", saves, (unsigned long long)c.sites);
+          os << line << sequence(rows[i].first, n) << "\n";
+        }
+      }
+    }
+
+  private:
+    struct Count {
+      uint64_t sites = 0;
+      uint64_t executed = 0;
+    };
+
+    size_t maxN_;
+    std::vector<std::unordered_map<uint64_t, Count>> grams_; // by length
+    uint64_t programs_ = 0, runs_ = 0, instructions_ = 0, dispatched_ = 0;
+
+    static std::string sequence(uint64_t key, size_t n) {
+      std::string out;
+      for (size_t i = n; i-- > 0;) {
+        if (!out.empty()) out += ' ';
+        out += op_name(Op(((key >> (8 * i)) & 0xff) - 1));
+      }
+      return out;
+    }
+  };
+
+} // namespace triad
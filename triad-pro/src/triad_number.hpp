@@ -0,0 +1,148 @@
+#pragma once
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <system_error>
+
+namespace triad {
+
+  // Numeric literal scanning and conversion straight off the source bytes:
+  // no temporary strings and no locale. Floats and exponents go through
+  // std::from_chars; 0x/0b/0o literals and short decimal integers take a
+  // table-driven integer path and come back flagged `integral`.
+  //
+  //   123  3.14  .5  1e9  2.5E-3  0xFF  0b1010  0o755
+  struct NumberLiteral {
+    size_t len = 0;        // bytes consumed
+    double value = 0.0;
+    bool integral = false; // integer literal, exactly representable in `value`
+    bool ok = false;       // false: missing digits (after 0x, '.', 'e') or out of range
+  };
+
+  namespace num_detail {
+
+    // Digit value for bases up to 16; 0xFF for anything else.
+    struct DigitTable {
+      uint8_t v[256];
+      constexpr DigitTable() : v{} {
+        for (int i = 0; i < 256; ++i) v[i] = 0xFF;
+        for (int c = '0'; c <= '9'; ++c) v[c] = static_cast<uint8_t>(c - '0');
+        for (int c = 'a'; c <= 'f'; ++c) v[c] = static_cast<uint8_t>(c - 'a' + 10);
+        for (int c = 'A'; c <= 'F'; ++c) v[c] = static_cast<uint8_t>(c - 'A' + 10);
+      }
+    };
+    inline constexpr DigitTable kDigits{};
+
+    constexpr uint64_t kExactLimit = uint64_t{1} << 53;
+
+    inline uint8_t digit(char c) noexcept { return kDigits.v[static_cast<unsigned char>(c)]; }
+    inline bool is_dec(char c) noexcept { return static_cast<unsigned char>(c - '0') < 10; }
+
+    // Power-of-two bases: one shift-or per digit, overflow when bits fall off the top.
+    inline NumberLiteral scan_pow2(const char* begin, const char* p, const char* end, unsigned shift) noexcept {
+      NumberLiteral r;
+      const uint8_t base = static_cast<uint8_t>(1u << shift);
+      const char* digits = p;
+      uint64_t acc = 0;
+      bool overflow = false;
+      for (uint8_t d; p < end && (d = digit(*p)) < base; ++p) {
+        overflow |= (acc >> (64 - shift)) != 0;
+        acc = (acc << shift) | d;
+      }
+      r.len = static_cast<size_t>(p - begin);
+      r.value = static_cast<double>(acc);
+      r.integral = acc <= kExactLimit;
+      r.ok = p != digits && !overflow;
+      return r;
+    }
+
+  } // namespace num_detail
+
+  // Longest numeric literal at p (which must start with a digit, or '.' then a digit).
+  inline NumberLiteral scan_number(const char* p, const char* end) noexcept {
+    using namespace num_detail;
+    const char* begin = p;
+    if (end - p >= 2 && p[0] == '0') {
+      switch (p[1]) {
+        case 'x': case 'X': return scan_pow2(begin, p + 2, end, 4);
+        case 'b': case 'B': return scan_pow2(begin, p + 2, end, 1);
+        case 'o': case 'O': return scan_pow2(begin, p + 2, end, 3);
+        default: break;
+      }
+    }
+
+    NumberLiteral r;
+    uint64_t acc = 0;
+    while (p < end && is_dec(*p)) acc = acc * 10 + static_cast<uint64_t>(*p++ - '0');
+    const size_t intDigits = static_cast<size_t>(p - begin);
+    bool isFloat = false;
+    if (p < end && *p == '.' && p + 1 < end && is_dec(p[1])) {
+      isFloat = true;
+      for (++p; p < end && is_dec(*p); ++p) {}
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+      isFloat = true;
+      ++p;
+      if (p < end && (*p == '+' || *p == '-')) ++p;
+      const char* exp = p;
+      while (p < end && is_dec(*p)) ++p;
+      if (p == exp) { r.len = static_cast<size_t>(p - begin); return r; }
+    }
+    r.len = static_cast<size_t>(p - begin);
+
+    if (!isFloat && intDigits > 0 && intDigits <= 19) {
+      // Cannot overflow uint64 at 19 digits; no from_chars round trip needed.
+      r.value = static_cast<double>(acc);
+      r.integral = acc <= kExactLimit;
+      r.ok = true;
+      return r;
+    }
+    auto res = std::from_chars(begin, p, r.value, std::chars_format::general);
+    r.ok = res.ec == std::errc{} && res.ptr == p;
+    r.integral = !isFloat && r.ok && r.value <= static_cast<double>(kExactLimit);
+    return r;
+  }
+
+  // Enough for any double format_number writes ("-2.2250738585072014e-308").
+  inline constexpr size_t kNumberChars = 32;
+
+  // The shortest text that reads back as exactly `v`, the one format for
+  // say/echo, string concatenation and serialized constants: 3, -0, 0.1,
+  // 0.30000000000000004, 1e+21, 5e-324, inf, nan. Integral values up to 2^53
+  // take an integer path. Writes at most kNumberChars bytes; returns the end.
+  // No locale.
+  inline char* format_number(double v, char* out) noexcept {
+    char* const last = out + kNumberChars;
+    const double limit = static_cast<double>(num_detail::kExactLimit);
+    if (v == std::trunc(v) && v >= -limit && v <= limit) {
+      if (v == 0 && std::signbit(v)) *out++ = '-';
+      return std::to_chars(out, last, static_cast<int64_t>(v)).ptr;
+    }
+    if (std::isnan(v)) { // to_chars would keep the sign bit
+      *out++ = 'n';
+      *out++ = 'a';
+      *out++ = 'n';
+      return out;
+    }
+#if defined(__cpp_lib_to_chars)
+    return std::to_chars(out, last, v).ptr;
+#else
+    // No floating-point to_chars in this standard library: the fewest
+    // significant digits that round-trip, 15 at the least.
+    for (int digits = 15;; ++digits) {
+      const int n = std::snprintf(out, kNumberChars, "%.*g", digits, v);
+      if (digits == 17 || std::strtod(out, nullptr) == v) return out + n;
+    }
+#endif
+  }
+
+  inline std::string number_to_string(double v) {
+    char buf[kNumberChars];
+    return std::string(buf, format_number(v, buf));
+  }
+
+} // namespace triad
@@ -0,0 +1,232 @@
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <climits>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace triad {
+
+  // When buffered say/echo output is handed to the kernel. Whatever the
+  // policy, a full buffer is written out, and so is everything left when the
+  // thread exits (or the program does).
+  enum class FlushPolicy {
+    Auto,     // Line on a terminal, Size otherwise
+    Line,     // after every line
+    Size,     // once `bytes` are buffered
+    Time,     // on the first line `interval` after the last write-out
+    Explicit, // on flush() only: the end of a VM run, or the program
+  };
+
+  struct OutputConfig {
+    FlushPolicy policy = FlushPolicy::Auto;
+    size_t bytes = size_t(1) << 20;
+    std::chrono::milliseconds interval{50};
+
+    // "line", "size[:bytes]", "time[:ms]", "explicit" or "auto" (triadc --flush).
+    static OutputConfig parse(std::string_view spec) {
+      OutputConfig c;
+      const size_t colon = spec.find(':');
+      const std::string_view name = spec.substr(0, colon);
+      const std::string arg = colon == std::string_view::npos ? std::string() : std::string(spec.substr(colon + 1));
+      if (name == "auto") c.policy = FlushPolicy::Auto;
+      else if (name == "line") c.policy = FlushPolicy::Line;
+      else if (name == "size") c.policy = FlushPolicy::Size;
+      else if (name == "time") c.policy = FlushPolicy::Time;
+      else if (name == "explicit") c.policy = FlushPolicy::Explicit;
+      else throw std::runtime_error("Unknown flush policy: " + std::string(spec));
+      if (!arg.empty() && c.policy == FlushPolicy::Size) c.bytes = std::max<size_t>(1, std::stoull(arg));
+      else if (!arg.empty() && c.policy == FlushPolicy::Time) c.interval = std::chrono::milliseconds(std::stoull(arg));
+      else if (!arg.empty()) throw std::runtime_error("Flush policy " + std::string(name) + " takes no argument");
+      return c;
+    }
+  };
+
+  // Shared by every thread's streams; set it before the program runs.
+  inline OutputConfig& output_config() noexcept {
+    static OutputConfig config;
+    return config;
+  }
+
+  // Output of say (stdout) or echo (stderr) for one thread. Lines collect in
+  // 64 KiB blocks and are written with one writev per flush, not one flushed
+  // iostream insertion each; a thread only ever writes out whole lines, so
+  // threads' output never interleaves within a line. Echo to a terminal
+  // bypasses the buffer: diagnostics show up at once. Echo to the file say
+  // writes to (2>&1) goes into say's buffer, keeping the two in order.
+  class OutputStream {
+  public:
+    explicit OutputStream(int fd) : fd_(fd) {
+#if defined(_WIN32)
+      tty_ = _isatty(fd) != 0;
+#else
+      tty_ = ::isatty(fd) != 0;
+#endif
+      unbuffered_ = fd == 2 && tty_;
+    }
+    ~OutputStream() { flush(); }
+
+    OutputStream(const OutputStream&) = delete;
+    OutputStream& operator=(const OutputStream&) = delete;
+
+    // Drop everything written from now on (benchmarks, corpus runs).
+    void set_discard(bool on) noexcept { discard_ = on; }
+
+    // Send buffered lines to `to` instead.
+    void merge_into(OutputStream& to) noexcept { merged_ = &to; }
+
+    // Keep lines back until the next flush() whatever the policy, so that
+    // output written meanwhile goes out together (one run-batch record);
+    // only kMaxBuffered still forces a write.
+    void set_hold(bool on) noexcept { held_ = on; }
+
+    // Whether the policy would write the buffer out now.
+    [[nodiscard]] bool flush_due() const {
+      if (buffered_ == 0) return false;
+      const OutputConfig& cfg = output_config();
+      FlushPolicy policy = cfg.policy;
+      if (policy == FlushPolicy::Auto) policy = tty_ ? FlushPolicy::Line : FlushPolicy::Size;
+      switch (policy) {
+        case FlushPolicy::Line: return true;
+        case FlushPolicy::Size: return buffered_ >= cfg.bytes;
+        case FlushPolicy::Time: return std::chrono::steady_clock::now() - lastFlush_ >= cfg.interval;
+        default: return false;
+      }
+    }
+
+    void write_line(std::string_view text) {
+      if (discard_) return;
+      if (merged_ && !unbuffered_) return merged_->write_line(text);
+      if (unbuffered_) {
+        flush();
+        const std::string_view parts[2] = {text, "\n"};
+        write_all(parts, 2);
+        return;
+      }
+      append(text);
+      append("\n");
+      if (buffered_ >= kMaxBuffered || (!held_ && flush_due())) flush();
+    }
+
+    void flush() {
+      lastFlush_ = std::chrono::steady_clock::now();
+      if (buffered_ == 0) return;
+      // Anything written through the iostreams so far goes first.
+      if (fd_ == 1) std::cout.flush();
+      std::fflush(fd_ == 1 ? stdout : stderr);
+      write_all(blocks_.data(), used_);
+      for (size_t i = 0; i < used_; ++i) blocks_[i].clear();
+      used_ = 0;
+      buffered_ = 0;
+    }
+
+  private:
+    static constexpr size_t kBlock = size_t(64) << 10;
+    static constexpr size_t kMaxBuffered = size_t(64) << 20; // Explicit, Time and held output still stop here
+
+    int fd_;
+    bool tty_ = false, unbuffered_ = false, discard_ = false, held_ = false;
+    OutputStream* merged_ = nullptr;
+    std::vector<std::string> blocks_; // [0, used_) hold output; the rest keep their capacity
+    size_t used_ = 0;
+    size_t buffered_ = 0;
+    std::chrono::steady_clock::time_point lastFlush_ = std::chrono::steady_clock::now();
+
+    void append(std::string_view s) {
+      if (used_ == 0 || blocks_[used_ - 1].size() + s.size() > std::max(kBlock, blocks_[used_ - 1].capacity())) {
+        if (used_ == blocks_.size()) blocks_.emplace_back();
+        blocks_[used_].reserve(std::max(kBlock, s.size()));
+        ++used_;
+      }
+      blocks_[used_ - 1].append(s);
+      buffered_ += s.size();
+    }
+
+    // Everything in `parts`, in order, retrying short writes; output that
+    // cannot be written (a closed pipe) is dropped, as iostreams would.
+    template <class Part>
+    void write_all(const Part* parts, size_t n) noexcept {
+#if defined(_WIN32)
+      for (size_t i = 0; i < n; ++i)
+        for (size_t done = 0; done < parts[i].size();) {
+          const int w = _write(fd_, parts[i].data() + done, unsigned(std::min<size_t>(parts[i].size() - done, 1u << 30)));
+          if (w <= 0) return;
+          done += size_t(w);
+        }
+#else
+      constexpr size_t kIov = 64 < IOV_MAX ? 64 : IOV_MAX;
+      iovec iov[kIov];
+      size_t first = 0, skip = 0; // parts[first] from byte `skip` is next
+      while (first < n) {
+        size_t k = 0;
+        for (size_t i = first; i < n && k < kIov; ++i, ++k) {
+          const size_t off = i == first ? skip : 0;
+          iov[k].iov_base = const_cast<char*>(parts[i].data() + off);
+          iov[k].iov_len = parts[i].size() - off;
+        }
+        const ssize_t w = ::writev(fd_, iov, int(k));
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return;
+        size_t left = size_t(w);
+        while (first < n && left >= parts[first].size() - skip) {
+          left -= parts[first].size() - skip;
+          ++first;
+          skip = 0;
+        }
+        skip += left;
+      }
+#endif
+    }
+  };
+
+  // The calling thread's say and echo streams.
+  inline OutputStream& say_stream() {
+    thread_local OutputStream s(1);
+    return s;
+  }
+  inline OutputStream& echo_stream() {
+    thread_local struct Echo {
+      OutputStream s{2};
+      Echo() {
+#if !defined(_WIN32)
+        struct stat out{}, err{};
+        if (::fstat(1, &out) == 0 && ::fstat(2, &err) == 0 && out.st_dev == err.st_dev && out.st_ino == err.st_ino)
+          s.merge_into(say_stream());
+#endif
+      }
+    } echo;
+    return echo.s;
+  }
+
+  // Write out both of this thread's streams (end of a run, before other
+  // output to the same terminal).
+  inline void flush_output() {
+    say_stream().flush();
+    echo_stream().flush();
+  }
+
+  // Hold this thread's say and echo output back (OutputStream::set_hold).
+  inline void hold_output(bool on) {
+    say_stream().set_hold(on);
+    echo_stream().set_hold(on);
+  }
+
+  // Write out this thread's streams if the flush policy wants either now.
+  inline void flush_output_if_due() {
+    if (say_stream().flush_due() || echo_stream().flush_due()) flush_output();
+  }
+
+} // namespace triad
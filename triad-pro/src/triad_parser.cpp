@@ -1,156 +1,252 @@
 #include "triad_lexer.hpp"
+#include "triad_token_stream.hpp"
+#include "triad_relex.hpp"
+#include "triad_pratt.hpp"
+#include "triad_limits.hpp"
+#include "triad_spsc.hpp"
+#include "triad_timeline.hpp"
 #include "triad_ast.hpp"
 #include "triad_bytecode.hpp"
 #include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <deque>
 #include <memory>
+#include <optional>
 #include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace triad {
 
+// Binary operators, loosest first. `or`/`and` are marked by their SC_*_BEGIN
+// op and compile to short-circuit sequences; the rest emit `op` after both
+// operands.
+inline constexpr pratt::Rule<TokKind, Op> kBinaryRules[] = {
+  {TokKind::KwOr, 1, Op::SC_OR_BEGIN},
+  {TokKind::KwAnd, 2, Op::SC_AND_BEGIN},
+  {TokKind::EqEq, 3, Op::EQ}, {TokKind::Ne, 3, Op::NE},
+  {TokKind::Lt, 3, Op::LT}, {TokKind::Le, 3, Op::LE},
+  {TokKind::Gt, 3, Op::GT}, {TokKind::Ge, 3, Op::GE},
+  {TokKind::Plus, 4, Op::ADD}, {TokKind::Minus, 4, Op::SUB},
+  {TokKind::Star, 5, Op::MUL}, {TokKind::Slash, 5, Op::DIV}, {TokKind::Percent, 5, Op::MOD},
+};
+inline constexpr pratt::BindingTable<TokKind, Op, static_cast<size_t>(TokKind::KwReturn) + 1> kBinary{kBinaryRules};
+
 struct Parser {
-  std::vector<Token> t; size_t i=0;
-  Parser(std::vector<Token> T):t(std::move(T)) {}
-  const Token& P() const { return t[i]; }
-  const Token& A(){ if (i<t.size()) ++i; return t[i-1]; }
-  bool M(TokKind k){ if (P().k==k){ A(); return true; } return false; }
+  // Tokens are pulled on demand. Their text is only valid until the stream
+  // moves on, so names are interned (N/KS) as soon as they are read.
+  TokenStream& ts;
+  explicit Parser(TokenStream& T, size_t maxDepth=kMaxNestingDepth):ts(T), maxDepth(maxDepth) {}
+  const Token& P(size_t k=0){ return ts.peek(k); }
+  const Token& A(){ return ts.advance(); }
+  bool M(TokKind k){ if (P().kind==k){ A(); return true; } return false; }
   void W(TokKind k,const char* m){ if(!M(k)) throw std::runtime_error(m); }
+  std::string_view S(const Token& tok) const { return ts.text(tok); }
+
+  // Only brackets recurse: a block, parenthesis or argument list holds a Nest
+  // from just after its opening token. Prefix operators and operator chains
+  // are handled in loops.
+  size_t depth = 0;
+  size_t maxDepth;
+  struct Nest {
+    Parser& p;
+    explicit Nest(Parser& q):p(q){
+      if (p.depth >= p.maxDepth){
+        const LineCol at = p.ts.where(p.ts.prev());
+        throw std::runtime_error("nesting deeper than " + std::to_string(p.maxDepth) + " levels at "
+                                 + std::to_string(at.line) + ":" + std::to_string(at.col));
+      }
+      ++p.depth;
+    }
+    ~Nest(){ --p.depth; }
+    Nest(const Nest&) = delete;
+    Nest& operator=(const Nest&) = delete;
+  };
 
   // Codegen helpers
   Chunk ch;
   int K(double d){ return ch.addConst(Value::number(d)); }
-  int KS(const std::string&s){ return ch.addConst(Value::string(s)); }
-  int N(const std::string& s){ return ch.addName(s); }
+  int KS(std::string_view s){ return ch.addConst(Value::string(std::string(s))); }
+  int N(std::string_view s){ return ch.addName(std::string(s)); }
   void E(Op op,int a=0,int b=0,int c=0){ ch.emit(op,a,b,c); }
   int EJ(Op op){ return ch.emit(op,-1,0,0); }
+  // Code emitted from here on belongs to the source at `off` (Chunk::lines).
+  void L(uint32_t off){ ch.lines.mark((int)ch.code.size(), off); }
 
   Chunk parse(){
-    while (P().k!=TokKind::Eof){
+    statements();
+    E(Op::RET);
+    return std::move(ch);
+  }
+
+  // Statements up to Eof without the RET: one batch of a pipelined build.
+  Chunk parseBatch(){
+    statements();
+    return std::move(ch);
+  }
+
+  void statements(){
+    while (P().kind!=TokKind::Eof){
       parseStmt();
       M(TokKind::Semicolon);
     }
-    E(Op::RET);
+  }
+
+  // One top-level statement (and its ';') as a chunk of its own, no RET.
+  // parse() is these units back to back; see IncrementalParser.
+  Chunk parseUnit(){
+    parseStmt();
+    M(TokKind::Semicolon);
     return std::move(ch);
   }
 
   void parseStmt(){
-    if (M(TokKind::KwIf)){ parseIf(); return; }
-    if (M(TokKind::KwFor)){ parseFor(); return; }
+    const uint32_t at = P().off;
+    L(at);
+    if (M(TokKind::KwIf)){ parseIf(at); return; }
+    if (M(TokKind::KwFor)){ parseFor(at); return; }
     if (M(TokKind::KwSay)){ parseExpr(); E(Op::SAY); return; }
     if (M(TokKind::KwEcho)){ parseExpr(); E(Op::ECHO); return; }
-    if (P().k==TokKind::Id && t[i+1].k==TokKind::Eq){ std::string n=A().s; A(); parseExpr(); E(Op::SET_VAR, N(n)); return; }
+    if (P().kind==TokKind::Id && P(1).kind==TokKind::Eq){ int n=N(S(A())); A(); parseExpr(); E(Op::SET_VAR, n); return; }
     parseExpr();
   }
 
   void parseBlock(){
     W(TokKind::LBrace,"{");
-    while (P().k!=TokKind::RBrace && P().k!=TokKind::Eof){
+    Nest nest(*this);
+    while (P().kind!=TokKind::RBrace && P().kind!=TokKind::Eof){
       parseStmt();
       M(TokKind::Semicolon);
     }
     W(TokKind::RBrace,"}");
   }
 
-  void parseIf(){
+  // `at`: offset of the keyword; code emitted between and after the blocks
+  // is attributed to it.
+  void parseIf(uint32_t at){
     W(TokKind::LParen,"("); parseExpr(); W(TokKind::RParen,")");
     int jElse = EJ(Op::IF_FALSE_JMP);
     parseBlock();
+    L(at);
     int jEnd = EJ(Op::JMP);
     ch.code[jElse].a = (int)ch.code.size();
     if (M(TokKind::KwElse)) parseBlock();
     ch.code[jEnd].a = (int)ch.code.size();
   }
 
-  void parseFor(){
-    if (P().k!=TokKind::Id) throw std::runtime_error("for ident");
-    std::string iv = A().s;
+  // for i in a..b: i runs from a up to, not including, b. The bound is
+  // evaluated once into a variable no program can name, one per nesting level.
+  // Input loops take their VM slot from the same count.
+  size_t loops = 0;
+  void parseFor(uint32_t at){
+    if (P().kind!=TokKind::Id) throw std::runtime_error("for ident");
+    int ivar = N(S(A()));
     W(TokKind::KwIn,"in");
-    parseExpr(); W(TokKind::Range,".."); parseExpr();
-    int ivar = N(iv);
-    int zero = K(0), one=K(1);
-    E(Op::PUSH_CONST, zero); E(Op::SET_VAR, ivar);
+    if (P().kind==TokKind::Id){
+      const std::string_view w = S(P());
+      const int source = w=="stdin" ? kIterStdin : w=="lines" ? kIterLines : w=="split" ? kIterSplit : -1;
+      if (source==kIterStdin ? P(1).kind==TokKind::LBrace : source>=0 && P(1).kind==TokKind::LParen){
+        parseForInput(at, ivar, source);
+        return;
+      }
+    }
+    int evar = N("for.end" + std::to_string(loops));
+    parseExpr(); E(Op::SET_VAR, ivar);
+    W(TokKind::Range,".."); parseExpr(); E(Op::SET_VAR, evar);
+    int one=K(1);
     int loopStart = (int)ch.code.size();
-    E(Op::PUSH_VAR, ivar); E(Op::PUSH_CONST, one); E(Op::LT);
+    E(Op::PUSH_VAR, ivar); E(Op::PUSH_VAR, evar); E(Op::LT);
     int jExit = EJ(Op::IF_FALSE_JMP);
-    parseBlock();
+    ++loops; parseBlock(); --loops;
+    L(at);
     E(Op::PUSH_VAR, ivar); E(Op::PUSH_CONST, one); E(Op::ADD); E(Op::SET_VAR, ivar);
     E(Op::JMP, loopStart);
     ch.code[jExit].a = (int)ch.code.size();
   }
 
-  // Expr precedence
-  void parseExpr(){ parseOr(); }
-  void parseOr(){
-    parseAnd();
-    while (M(TokKind::KwOr)){
-      int t=0; E(Op::SC_OR_BEGIN,t);
-      int j=EJ(Op::SC_OR_EVAL);
-      parseAnd();
-      int end = ch.emit(Op::SC_OR_END);
-      ch.code[j].b = end;
+  // for line in stdin / lines(path), for field in split(text[, sep]): one
+  // iteration per line or field, read as the loop runs. The input lives in
+  // the VM slot of this nesting level.
+  void parseForInput(uint32_t at, int ivar, int source){
+    const int slot = (int)loops;
+    A();
+    if (source!=kIterStdin){
+      W(TokKind::LParen,"(");
+      Nest nest(*this);
+      parseExpr();
+      if (source==kIterSplit){ if (M(TokKind::Comma)) parseExpr(); else E(Op::PUSH_CONST, KS("")); }
+      W(TokKind::RParen,")");
     }
+    E(Op::ITER_OPEN, slot, source);
+    int loopStart = (int)ch.code.size();
+    int jExit = ch.emit(Op::ITER_NEXT, ivar, -1, slot);
+    ++loops; parseBlock(); --loops;
+    L(at);
+    E(Op::JMP, loopStart);
+    ch.code[jExit].b = (int)ch.code.size();
   }
-  void parseAnd(){
-    parseCmp();
-    while (M(TokKind::KwAnd)){
-      int t=0; E(Op::SC_AND_BEGIN,t);
-      int j=EJ(Op::SC_AND_EVAL);
-      parseCmp();
-      int end = ch.emit(Op::SC_AND_END);
+
+  // Expressions: binary operators by precedence climbing over kBinary.
+  void parseExpr(){ pratt::climb(kBinary, *this); }
+  TokKind peek_kind(){ return P().kind; }
+  void skip(){ A(); }
+  pratt::None operand(){ parseUnary(); return {}; }
+  template <class Rhs> pratt::None infix(pratt::None, Op op, Rhs rhs){
+    if (op==Op::SC_OR_BEGIN || op==Op::SC_AND_BEGIN){
+      const bool isOr = op==Op::SC_OR_BEGIN;
+      E(op, 0);
+      int j=EJ(isOr ? Op::SC_OR_EVAL : Op::SC_AND_EVAL);
+      rhs();
+      int end = ch.emit(isOr ? Op::SC_OR_END : Op::SC_AND_END);
       ch.code[j].b = end;
+    } else {
+      rhs(); E(op);
     }
-  }
-  void parseCmp(){
-    parseAdd();
-    while (P().k==TokKind::EqEq||P().k==TokKind::Ne||P().k==TokKind::Lt||P().k==TokKind::Le||P().k==TokKind::Gt||P().k==TokKind::Ge){
-      TokKind k=A().k; parseAdd();
-      E(k==TokKind::EqEq?Op::EQ: k==TokKind::Ne?Op::NE: k==TokKind::Lt?Op::LT: k==TokKind::Le?Op::LE: k==TokKind::Gt?Op::GT:Op::GE);
-    }
-  }
-  void parseAdd(){
-    parseMul();
-    while (P().k==TokKind::Plus || P().k==TokKind::Minus){
-      TokKind k=A().k; parseMul(); E(k==TokKind::Plus?Op::ADD:Op::SUB);
-    }
-  }
-  void parseMul(){
-    parseUnary();
-    while (P().k==TokKind::Star||P().k==TokKind::Slash||P().k==TokKind::Percent){
-      TokKind k=A().k; parseUnary(); E(k==TokKind::Star?Op::MUL: k==TokKind::Slash?Op::DIV:Op::MOD);
-    }
+    return {};
   }
   void parseUnary(){
-    if (M(TokKind::Minus)){ parseUnary(); E(Op::NEG); return; }
-    if (M(TokKind::Bang)){ parseUnary(); E(Op::NOT); return; }
+    if (P().kind!=TokKind::Minus && P().kind!=TokKind::Bang){ parsePrimary(); return; }
+    std::vector<Op> prefix; // applied innermost first
+    for (;;){
+      if (M(TokKind::Minus)) prefix.push_back(Op::NEG);
+      else if (M(TokKind::Bang)) prefix.push_back(Op::NOT);
+      else break;
+    }
     parsePrimary();
+    for (auto it = prefix.rbegin(); it != prefix.rend(); ++it) E(*it);
   }
 
   void parsePrimary(){
     if (M(TokKind::LParen)){
-      int nargs=0; if (P().k!=TokKind::RParen){ do{ parseExpr(); ++nargs; } while (M(TokKind::Comma)); }
+      Nest nest(*this);
+      int nargs=0; if (P().kind!=TokKind::RParen){ do{ parseExpr(); ++nargs; } while (M(TokKind::Comma)); }
       W(TokKind::RParen,")"); if (nargs>1) E(Op::MAKE_TUPLE, nargs); return;
     }
-    if (M(TokKind::Num)){ int k=K(t[i-1].n); E(Op::PUSH_CONST,k); return; }
-    if (M(TokKind::Str)){ int k=KS(t[i-1].s); E(Op::PUSH_CONST,k); return; }
-    if (M(TokKind::KwNew)){ if (P().k!=TokKind::Id) throw std::runtime_error("class"); std::string cls=A().s;
-      W(TokKind::LParen,"("); int argc=0; if (P().k!=TokKind::RParen){ do{ parseExpr(); ++argc; } while(M(TokKind::Comma)); } W(TokKind::RParen,")");
-      E(Op::NEW_CLASS, N(cls)); if (argc>0) E(Op::CALL_METHOD, N("init"), argc); return; }
-    if (M(TokKind::Id)){ int k=N(t[i-1].s); E(Op::PUSH_VAR,k);
+    if (M(TokKind::Num)){ int k=K(ts.prev().number); E(Op::PUSH_CONST,k); return; }
+    if (M(TokKind::Str)){ int k=KS(S(ts.prev())); E(Op::PUSH_CONST,k); return; }
+    if (M(TokKind::KwNew)){ if (P().kind!=TokKind::Id) throw std::runtime_error("class"); int cls=N(S(A()));
+      W(TokKind::LParen,"("); Nest nest(*this); int argc=0; if (P().kind!=TokKind::RParen){ do{ parseExpr(); ++argc; } while(M(TokKind::Comma)); } W(TokKind::RParen,")");
+      E(Op::NEW_CLASS, cls); if (argc>0) E(Op::CALL_METHOD, N("init"), argc); return; }
+    if (M(TokKind::Id)){ int k=N(S(ts.prev())); E(Op::PUSH_VAR,k);
       // chain: .name or [index] and call .name(...)
       for(;;){
         if (M(TokKind::Dot)){
-          if (P().k!=TokKind::Id) throw std::runtime_error("field/call");
-          std::string nm = A().s;
+          if (P().kind!=TokKind::Id) throw std::runtime_error("field/call");
+          int nm = N(S(A()));
           if (M(TokKind::LParen)){
-            int argc=0; if (P().k!=TokKind::RParen){ do{ parseExpr(); ++argc; } while(M(TokKind::Comma)); } W(TokKind::RParen,")");
-            E(Op::CALL_METHOD, N(nm), argc);
+            Nest nest(*this);
+            int argc=0; if (P().kind!=TokKind::RParen){ do{ parseExpr(); ++argc; } while(M(TokKind::Comma)); } W(TokKind::RParen,")");
+            E(Op::CALL_METHOD, nm, argc);
           } else {
-            E(Op::GET_FIELD, N(nm));
+            E(Op::GET_FIELD, nm);
           }
           continue;
         }
         if (M(TokKind::LBracket)){
-          if (P().k!=TokKind::Num) throw std::runtime_error("index");
-          int idx=(int)A().n; W(TokKind::RBracket,"]");
+          if (P().kind!=TokKind::Num || !P().integral) throw std::runtime_error("index");
+          int idx=(int)A().number; W(TokKind::RBracket,"]");
           E(Op::GET_FIELD, N(std::to_string(idx))); // treat index as dotted field segment
           continue;
         }
@@ -162,317 +258,301 @@ struct Parser {
   }
 };
 
-static Chunk parse_to_chunk(const std::string& src){
-  Lexer lx(src); auto toks = lx.run();
-  Parser p(std::move(toks)); return p.parse();
+static Chunk parse_to_chunk(std::string_view src, size_t maxDepth=kMaxNestingDepth){
+  TokenStream ts(src);
+  Parser p(ts, maxDepth); return p.parse();
 }
 
-// --- Additional: Utility to pretty-print a Chunk for debugging ---
-
-#include <iostream>
+// Parse tokens lexed beforehand from `src` (Lexer::run(), ending in Eof);
+// triadc --time-phases times the lexer on its own this way.
+static Chunk parse_tokens(std::string_view src, const std::vector<Token>& toks, size_t maxDepth=kMaxNestingDepth){
+  TokenStream ts(src, toks.data(), toks.data() + toks.size());
+  Parser p(ts, maxDepth); return p.parse();
+}
 
-namespace triad {
+// Lex and parse straight off a stream (stdin, pipes) without reading it whole.
+static Chunk parse_to_chunk(std::istream& in, size_t maxDepth=kMaxNestingDepth){
+  TokenStream ts(in);
+  Parser p(ts, maxDepth); return p.parse();
+}
 
-void dump_chunk(const Chunk& ch) {
-  std::cout << "Chunk dump:\n";
-  for (size_t i = 0; i < ch.code.size(); ++i) {
-    const Instr& instr = ch.code[i];
-    std::cout << "  [" << i << "] Op: " << static_cast<int>(instr.op)
-              << " a: " << instr.a << " b: " << instr.b << " c: " << instr.c << "\n";
-  }
-  std::cout << "Constants:\n";
-  for (size_t i = 0; i < ch.consts.size(); ++i) {
-    const Value& v = ch.consts[i];
-    if (v.tag == Value::Num)
-      std::cout << "  [" << i << "] Num: " << v.num << "\n";
-    else if (v.tag == Value::Str)
-      std::cout << "  [" << i << "] Str: \"" << v.str << "\"\n";
-  }
-  std::cout << "Names:\n";
-  for (size_t i = 0; i < ch.names.size(); ++i) {
-    std::cout << "  [" << i << "] " << ch.names[i] << "\n";
+// Append a unit compiled on its own to `out`: constant and name indices
+// move past the ones already there, jump targets past the code. `offShift`
+// moves its source offsets (text before it was edited since it was compiled).
+static void link_unit(Chunk& out, const Chunk& unit, int64_t offShift=0){
+  const int code = (int)out.code.size(), k = (int)out.consts.size(), n = (int)out.names.size();
+  for (Instr in : unit.code){
+    switch (in.op){
+      case Op::PUSH_CONST: in.a += k; break;
+      case Op::PUSH_VAR: case Op::SET_VAR: case Op::GET_FIELD:
+      case Op::CALL_METHOD: case Op::NEW_CLASS: in.a += n; break;
+      case Op::IF_FALSE_JMP: case Op::JMP: in.a += code; break;
+      case Op::SC_AND_EVAL: case Op::SC_OR_EVAL: in.b += code; break;
+      case Op::ITER_NEXT: in.a += n; in.b += code; break;
+      default: break;
+    }
+    out.code.push_back(in);
   }
+  out.consts.insert(out.consts.end(), unit.consts.begin(), unit.consts.end());
+  out.names.insert(out.names.end(), unit.names.begin(), unit.names.end());
+  out.lines.append(unit.lines, code, offShift);
 }
 
-} // namespace triad
+// A document kept compiled across edits (triadc --watch, editor tooling).
+// Tokens and one chunk per top-level statement are kept between edits; an
+// edit re-lexes its token window (relex) and recompiles only the statements
+// whose tokens, or the one token of lookahead after them, it touched. The
+// statements after it are reused as soon as reparsing lines up with one of
+// them again. link() yields the same chunk parse_to_chunk() would.
+class IncrementalParser {
+  struct Unit { size_t first; size_t count; Chunk chunk; uint32_t off; }; // tokens [first, first + count); off: toks_[first].off when compiled
 
-// --- Additional: Utility to disassemble a single instruction for debugging ---
+  std::string src_;
+  std::vector<Token> toks_{Token{}};
+  std::vector<Unit> units_;
+  bool stale_ = false; // last relex or reparse failed: units_ no longer match toks_
+  size_t maxDepth_ = kMaxNestingDepth;
 
-namespace triad {
+public:
+  struct Stats { size_t tokensRelexed = 0; size_t unitsReparsed = 0; size_t units = 0; };
 
-std::string disasm_instr(const Instr& instr, const Chunk& ch) {
-  std::string out = "Op: " + std::to_string(static_cast<int>(instr.op));
-  out += " a: " + std::to_string(instr.a);
-  out += " b: " + std::to_string(instr.b);
-  out += " c: " + std::to_string(instr.c);
-
-  // Optionally, show constant or name if relevant
-  if (instr.op == Op::PUSH_CONST && instr.a >= 0 && instr.a < static_cast<int>(ch.consts.size())) {
-    const Value& v = ch.consts[instr.a];
-    if (v.tag == Value::Num)
-      out += " ; const(num): " + std::to_string(v.num);
-    else if (v.tag == Value::Str)
-      out += " ; const(str): \"" + v.str + "\"";
-  }
-  if ((instr.op == Op::PUSH_VAR || instr.op == Op::SET_VAR || instr.op == Op::GET_FIELD || instr.op == Op::CALL_METHOD || instr.op == Op::NEW_CLASS)
-      && instr.a >= 0 && instr.a < static_cast<int>(ch.names.size())) {
-    out += " ; name: " + ch.names[instr.a];
-  }
-  return out;
-}
+  IncrementalParser() = default;
+  explicit IncrementalParser(std::string text){ update(std::move(text)); }
 
-} // namespace triad
+  // Takes effect from the next edit.
+  void set_max_depth(size_t maxDepth) noexcept { maxDepth_ = maxDepth; }
 
-#ifdef TRIAD_PARSER_TEST_MAIN
-#include <string>
-
-int main() {
-  using namespace triad;
-  std::string src = "say 1+2*3;";
-  Chunk ch = parse_to_chunk(src);
-  dump_chunk(ch);
-  return 0;
-}
-#endif
+  [[nodiscard]] std::string_view text() const noexcept { return src_; }
+  [[nodiscard]] size_t units() const noexcept { return units_.size(); }
 
-#ifdef TRIAD_PARSER_DISASM_MAIN
-#include <string>
-
-int main() {
-  using namespace triad;
-  std::string src = "x = 42; say x;";
-  Chunk ch = parse_to_chunk(src);
-  std::cout << "Disassembly:\n";
-  for (size_t i = 0; i < ch.code.size(); ++i) {
-    std::cout << "[" << i << "] " << disasm_instr(ch.code[i], ch) << "\n";
+  // Replace the whole text (a file saved from outside); the edit is inferred.
+  Stats update(std::string text){
+    const TextEdit e = edit_between(src_, text);
+    return apply(std::move(text), e);
   }
-  return 0;
-}
-#endif
-// --- Additional: Utility to serialize and deserialize Chunk to/from a simple text format ---
-#include <sstream>
-#include <fstream>
-#include <string>
-#include <stdexcept>
-namespace triad {
-	// Serialize a Chunk to a text stream (for debugging or simple persistence)
-    inline void serialize_chunk(const Chunk& ch, std::ostream& os) {
-        os << "CHUNK\n";
-        os << "CODE " << ch.code.size() << "\n";
-        for (const auto& instr : ch.code) {
-            os << static_cast<int>(instr.op) << " " << instr.a << " " << instr.b << " " << instr.c << "\n";
-        }
-        os << "CONSTS " << ch.consts.size() << "\n";
-        for (const auto& v : ch.consts) {
-            if (v.tag == Value::Num) {
-                os << "N " << v.num << "\n";
-            } else if (v.tag == Value::Str) {
-                os << "S " << v.str << "\n";
-            }
-        }
-        os << "NAMES " << ch.names.size() << "\n";
-        for (const auto& name : ch.names) {
-            os << name << "\n";
-        }
-	}
-    // Deserialize a Chunk from a text stream
-    inline Chunk deserialize_chunk(std::istream& is) {
-        Chunk ch;
-        std::string header;
-        is >> header;
-        if (header != "CHUNK") throw std::runtime_error("Invalid chunk header");
-        std::string section;
-        size_t count = 0;
-        is >> section >> count;
-        if (section != "CODE") throw std::runtime_error("Expected CODE section");
-        for (size_t i = 0; i < count; ++i) {
-            int op, a, b, c;
-            is >> op >> a >> b >> c;
-            ch.code.push_back({static_cast<Op>(op), a, b, c});
-        }
-        is >> section >> count;
-        if (section != "CONSTS") throw std::runtime_error("Expected CONSTS section");
-        for (size_t i = 0; i < count; ++i) {
-            char type;
-            is >> type;
-            if (type == 'N') {
-                double num;
-                is >> num;
-                ch.consts.push_back(Value::number(num));
-            } else if (type == 'S') {
-                std::string str;
-                is >> std::ws;
-                std::getline(is, str);
-                ch.consts.push_back(Value::string(str));
-            }
-        }
-        is >> section >> count;
-        if (section != "NAMES") throw std::runtime_error("Expected NAMES section");
-        is >> std::ws;
-        for (size_t i = 0; i < count; ++i) {
-            std::string name;
-            std::getline(is, name);
-            ch.names.push_back(name);
-        }
-        return ch;
-	}
-#ifdef TRIAD_SERIALIZE_MAIN
-    int main(int argc, char** argv) {
-        if (argc < 2) {
-            std::cerr << "Usage: triad_serialize <input.triad> [output.chunk]\n";
-            return 1;
-        }
-        std::string inputFile = argv[1];
-        std::string outputFile = argc > 2 ? argv[2] : "";
-        std::ifstream ifs(inputFile);
-        if (!ifs) {
-            std::cerr << "Error opening input file: " << inputFile << "\n";
-            return 1;
-        }
-        Chunk ch = parse_to_chunk(ifs);
-        ifs.close();
-        if (!outputFile.empty()) {
-            std::ofstream ofs(outputFile);
-            if (!ofs) {
-                std::cerr << "Error opening output file: " << outputFile << "\n";
-                return 1;
-            }
-            serialize_chunk(ch, ofs);
-            ofs.close();
-            std::cout << "Serialized chunk to " << outputFile << "\n";
-        } else {
-            serialize_chunk(ch, std::cout);
-        }
-        return 0;
-	}
-#endif
-} // namespace triad
-// --- Additional: Utility to disassemble a Chunk from a .triad file ---
-#ifdef TRIAD_DISASM_MAIN
-#include <string>
-#include <fstream>
-int main(int argc, char** argv) {
-  using namespace triad;
-  if (argc < 2) {
-    std::cout << "Usage: triad_disasm <file.triad>\n";
-    return 1;
-  }
-  std::string inputFile = argv[1];
-  std::ifstream ifs(inputFile);
-  if (!ifs) {
-    std::cerr << "Error opening file: " << inputFile << "\n";
-    return 1;
-  }
-  Chunk ch = parse_to_chunk(ifs);
-  ifs.close();
-  std::cout << "Disassembly of " << inputFile << ":\n";
-  for (size_t i = 0; i < ch.code.size(); ++i) {
-    std::cout << "[" << i << "] " << disasm_instr(ch.code[i], ch) << "\n";
-  }
-  return 0;
-}
-#endif
-// --- Main program to parse command line and run modes ---
-#ifdef TRIAD_PARSER_MAIN
-#include <string>
-#include <iostream>
-#include <fstream>
-#include <stdexcept>
-int main(int argc, char** argv) {
-  if (argc < 2) {
-    std::cout << "Triad Compiler CLI\n"
-              << "Usage: triadc <mode> <file.triad | dir> [options]\n"
-              << "Modes:\n"
-              << "  run-vm       Execute via VM\n"
-              << "  run-ast      Execute via AST interpreter\n"
-              << "  emit-nasm    Emit NASM assembly\n"
-              << "  emit-llvm    Emit LLVM IR\n"
-              << "  run-tests    Execute all .triad files in /tests\n"
-              << "Options:\n"
-              << "  -o <file>    Output to file\n"
-              << "  --verbose    Show debug info\n"
-              << "  --show-ast   Print AST\n"
-              << "  --show-bytecode Print bytecode\n"
-		<< "  --trace-vm   Trace
-        << "  --version    Show version\n";
-    return 0;
+
+  // Replace `removed` bytes at `off` with `inserted` (an editor change event).
+  // The edit is kept even if it throws (typing `0x1F` passes through `0x`),
+  // so the next event's offsets still refer to text() as the editor has it.
+  Stats edit(size_t off, size_t removed, std::string_view inserted){
+    std::string text = src_;
+    text.replace(off, removed, inserted);
+    return apply(std::move(text), TextEdit{off, removed, inserted.size()});
   }
-  std::string mode = argv[1];
-  std::string input = argc > 2 ? argv[2] : "";
-  std::string outFile;
-  bool verbose = false, showAst = false, showBytecode = false, traceVm = false;
-  for (int i = 3; i < argc; ++i) {
-    std::string arg = argv[i];
-    if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-    else if (arg == "--verbose") verbose = true;
-    else if (arg == "--show-ast") showAst = true;
-    else if (arg == "--show-bytecode") showBytecode = true;
-    else if (arg == "--trace-vm") traceVm = true;
-	else if (arg == "--version") {
-        std::cout << "Triad Compiler v0.9.1\n";
-        return 0;
-    } else {
-      std::cerr << "Unknown argument: " << arg << "\n";
-      return 1;
-    }
+
+  [[nodiscard]] Chunk link() const {
+    Chunk out;
+    size_t code = 1, consts = 0, names = 0;
+    for (const Unit& u : units_){ code += u.chunk.code.size(); consts += u.chunk.consts.size(); names += u.chunk.names.size(); }
+    out.code.reserve(code); out.consts.reserve(consts); out.names.reserve(names);
+    for (const Unit& u : units_) link_unit(out, u.chunk, int64_t(toks_[u.first].off) - u.off);
+    out.emit(Op::RET);
+    return out;
   }
-  try {
-    if (mode == "run-tests") {
-      // run_tests(verbose); // Implement test runner as needed
-      std::cout << "[Test runner not yet implemented]\n";
-      return 0;
+
+private:
+  Stats apply(std::string text, const TextEdit& e){
+    TokenDelta d;
+    try {
+      d = relex(toks_, text, e); // throws before changing anything
+    } catch (...) {
+      // Take the text regardless; with no tokens left, the next edit lexes
+      // it in full and reparses every unit.
+      src_ = std::move(text);
+      toks_.clear();
+      units_.clear();
+      stale_ = true;
+      throw;
     }
-    if (input.empty()) {
-      std::cerr << "Error: No input file specified.\n";
-      return 1;
+    src_ = std::move(text);
+    Stats st;
+    st.tokensRelexed = d.last - d.first;
+
+    size_t keep = 0, reuse = units_.size();
+    if (!stale_){
+      // Units that read nothing at or past d.first stay; units starting at or
+      // after d.oldLast may be picked up again below.
+      while (keep < units_.size() && units_[keep].first + units_[keep].count < d.first) ++keep;
+      reuse = keep;
+      while (reuse < units_.size() && units_[reuse].first < d.oldLast) ++reuse;
     }
-	std::string src = slurp(input);
-    Chunk ch = parse_to_chunk(src);
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) dump_chunk(ch);
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
+    const size_t moved = d.last - d.oldLast; // wraps when tokens went away
+    std::vector<Unit> fresh;
+    size_t pos = keep ? units_[keep - 1].first + units_[keep - 1].count : 0;
+    try {
+      while (toks_[pos].kind != TokKind::Eof){
+        if (reuse < units_.size() && units_[reuse].first + moved == pos) break;
+        TokenStream ts(src_, toks_.data() + pos, toks_.data() + toks_.size());
+        Parser p(ts, maxDepth_);
+        Unit u{pos, 0, p.parseUnit(), toks_[pos].off};
+        u.count = ts.consumed();
+        pos += u.count;
+        fresh.push_back(std::move(u));
+        while (reuse < units_.size() && units_[reuse].first + moved < pos) ++reuse;
+      }
+    } catch (...) {
+      units_.clear();
+      stale_ = true;
+      throw;
     }
-    // Handle other modes: run-vm, run-ast, emit-nasm, emit-llvm
-    if (mode == "run-vm") {
-      std::cout << "[VM execution not yet implemented]\n";
-    } else if (mode == "run-ast") {
-      std::cout << "[AST interpreter not yet implemented]\n";
-    } else if (mode == "emit-nasm") {
-      std::cout << "[NASM emission not yet implemented]\n";
-    } else if (mode == "emit-llvm") {
-      std::cout << "[LLVM IR emission not yet implemented]\n";
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
+    if (toks_[pos].kind == TokKind::Eof) reuse = units_.size();
+
+    if (moved != 0){
+      for (size_t i = reuse; i < units_.size(); ++i) units_[i].first += moved;
     }
-  } catch (const std::exception& e) {
-      std::cerr << "Error: " << e.what() << "\n";
-      return 1;
+    replace_range(units_, keep, reuse, std::make_move_iterator(fresh.begin()), std::make_move_iterator(fresh.end()));
+    stale_ = false;
+    st.unitsReparsed = fresh.size();
+    st.units = units_.size();
+    return st;
   }
-  return 0;
-}
-#endif
-//       std::cout << "[AST dump not yet implemented]\n";
-      return;
+};
+
+namespace pipeline {
+
+  struct TokenBlock { std::vector<Token> toks; bool last = false; };
+
+  struct Batch {
+    std::vector<Token> toks; // top-level statements, then an Eof sentinel
+    Chunk chunk;
+  };
+
+  constexpr size_t kBlockTokens = 4096;  // lexer -> splitter
+  constexpr size_t kBatchTokens = 16384; // a batch ends at the first statement start past this
+  constexpr size_t kQueueSlots = 64;
+  constexpr size_t kMinBytes = 256 * 1024; // below this, starting threads costs more than it saves
+
+  // Whether a top-level statement surely starts at a token of kind `tok`
+  // (bracket depth 0, after a token of kind `prev`). The parser never
+  // continues a statement with a statement keyword, an identifier right
+  // after a complete operand, or anything after ';', so a batch cut there
+  // parses exactly as it does in place.
+  inline bool starts_statement(TokKind prev, TokKind tok) noexcept {
+    switch (tok){
+      case TokKind::KwIf: case TokKind::KwFor: case TokKind::KwSay: case TokKind::KwEcho: return true;
+      default: break;
     }
-    // Handle other modes: run-vm, run-ast, emit-nasm, emit-llvm
-    if (mode == "run-vm") {
-      std::cout << "[VM execution not yet implemented]\n";
-    } else if (mode == "run-ast") {
-      std::cout << "[AST interpreter not yet implemented]\n";
-    } else if (mode == "emit-nasm") {
-      std::cout << "[NASM emission not yet implemented]\n";
-    } else if (mode == "emit-llvm") {
-      std::cout << "[LLVM IR emission not yet implemented]\n";
-    } else {
-		std::cerr << "Unknown mode: " << mode << "\n";
-        return 1;
+    if (prev==TokKind::Semicolon) return true;
+    if (tok!=TokKind::Id) return false;
+    switch (prev){
+      case TokKind::Id: case TokKind::Num: case TokKind::Str:
+      case TokKind::RParen: case TokKind::RBracket: case TokKind::RBrace: return true;
+      default: return false;
     }
-  } catch (const std::exception& e) {
-      std::cerr << "Error: " << e.what() << "\n";
-      return 1;
   }
-  return 0;
+
+} // namespace pipeline
+
+// Pipelined compile of an in-memory source (triadc --pipeline): a lexer
+// thread produces token blocks, this thread cuts them into batches of whole
+// top-level statements, and `workers` threads compile the batches, which are
+// then linked in source order. Stages hand over through lock-free queues, so
+// wall-clock time tends to the slowest stage. The result is the chunk
+// parse_to_chunk() would build; if any stage fails, the source is compiled
+// again sequentially so that the error is the one it would report.
+// workers == 0 picks one per core beyond the lexer's and this thread's, and
+// compiles small sources or on a single core sequentially.
+static Chunk parse_to_chunk_pipelined(std::string_view src, size_t maxDepth=kMaxNestingDepth, unsigned workers=0){
+  using namespace pipeline;
+  Lexer::check_size(src.size()); // before the lexer thread, which could only terminate on it
+  if (workers==0){
+    const unsigned hw = std::thread::hardware_concurrency();
+    if (hw < 2 || src.size() < kMinBytes) return parse_to_chunk(src, maxDepth);
+    workers = hw > 2 ? hw - 2 : 1;
   }
+  std::atomic<bool> failed{false};
 
+  SpscQueue<TokenBlock, kQueueSlots> blocks;
+  std::thread lexer([&]{
+    if (Timeline* tl = Timeline::active()) tl->name_thread("lexer");
+    TimelineSpan span("compile", "lex");
+    Lexer lx(src);
+    try {
+      for (bool last = false; !last;){
+        TokenBlock b;
+        b.toks.reserve(kBlockTokens);
+        while (b.toks.size() < kBlockTokens && !b.last){
+          b.toks.push_back(lx.next());
+          b.last = b.toks.back().kind==TokKind::Eof;
+        }
+        last = b.last = b.last || failed.load(std::memory_order_relaxed);
+        blocks.push(std::move(b));
+      }
+    } catch (...) {
+      failed = true;
+      TokenBlock b;
+      b.last = true;
+      blocks.push(std::move(b));
+    }
+  });
+
+  std::deque<Batch> batches; // elements stay put while workers hold them
+  std::vector<std::unique_ptr<SpscQueue<Batch*, kQueueSlots>>> queues;
+  std::vector<std::thread> pool;
+  for (unsigned w = 0; w < workers; ++w) queues.push_back(std::make_unique<SpscQueue<Batch*, kQueueSlots>>());
+  for (unsigned w = 0; w < workers; ++w){
+    pool.emplace_back([&, w]{
+      if (Timeline* tl = Timeline::active()) tl->name_thread("compile " + std::to_string(w + 1));
+      while (Batch* b = queues[w]->pop()){
+        if (failed.load(std::memory_order_relaxed)) continue;
+        TimelineSpan span("task", "compile batch");
+        if (span.recording()) span.detail(std::to_string(b->toks.size() - 1) + " tokens");
+        try {
+          TokenStream ts(src, b->toks.data(), b->toks.data() + b->toks.size());
+          Parser p(ts, maxDepth);
+          b->chunk = p.parseBatch();
+        } catch (...) {
+          failed = true;
+        }
+      }
+    });
+  }
+
+  // Split on this thread; it always drains the lexer so that it can finish.
+  Batch cur;
+  unsigned next = 0;
+  auto ship = [&](uint32_t end){
+    cur.toks.emplace_back(TokKind::Eof, end, 0);
+    batches.push_back(std::move(cur));
+    cur = Batch{};
+    queues[next]->push(&batches.back());
+    next = (next + 1) % workers;
+  };
+  TokKind prev = TokKind::Eof;
+  long depth = 0;
+  uint32_t eof = (uint32_t)src.size();
+  std::optional<TimelineSpan> split(std::in_place, "compile", "split");
+  for (bool last = false; !last;){
+    TokenBlock blk = blocks.pop();
+    last = blk.last;
+    if (failed.load(std::memory_order_relaxed)) continue;
+    for (const Token& t : blk.toks){
+      if (t.kind==TokKind::Eof){ eof = t.off; break; }
+      if (depth==0 && cur.toks.size() >= kBatchTokens && pipeline::starts_statement(prev, t.kind)) ship(t.off);
+      switch (t.kind){
+        case TokKind::LParen: case TokKind::LBrace: case TokKind::LBracket: ++depth; break;
+        case TokKind::RParen: case TokKind::RBrace: case TokKind::RBracket: --depth; break;
+        default: break;
+      }
+      cur.toks.push_back(t);
+      prev = t.kind;
+    }
+  }
+  if (!failed) ship(eof);
+  for (auto& q : queues) q->push(nullptr);
+  split.reset();
+  lexer.join();
+  for (std::thread& t : pool) t.join();
+  if (failed) return parse_to_chunk(src, maxDepth);
+
+  TimelineSpan link("compile", "link");
+  Chunk out;
+  size_t code = 1, consts = 0, names = 0;
+  for (const Batch& b : batches){ code += b.chunk.code.size(); consts += b.chunk.consts.size(); names += b.chunk.names.size(); }
+  out.code.reserve(code); out.consts.reserve(consts); out.names.reserve(names);
+  for (const Batch& b : batches) link_unit(out, b.chunk);
+  out.emit(Op::RET);
+  return out;
+}
+
+} // namespace triad
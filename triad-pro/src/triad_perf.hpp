@@ -0,0 +1,159 @@
+#pragma once
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace triad {
+
+  enum class HwEvent { Cycles, Instructions, BranchMisses, L1dMisses, LlcMisses, DtlbMisses };
+  inline constexpr size_t kHwEventCount = size_t(HwEvent::DtlbMisses) + 1;
+
+  inline const char* hw_event_name(HwEvent e) {
+    static constexpr const char* kNames[kHwEventCount] = {
+      "cycles", "instructions", "branch-misses", "L1d-misses", "LLC-misses", "dTLB-misses",
+    };
+    return kNames[size_t(e)];
+  }
+
+  // Counts for one measured stretch. Counters the kernel shared with other
+  // events were running only part of the time; their counts are scaled up to
+  // the whole stretch.
+  struct HwReading {
+    bool have[kHwEventCount] = {};
+    double value[kHwEventCount] = {};
+
+    [[nodiscard]] bool any() const noexcept {
+      for (bool h : have)
+        if (h) return true;
+      return false;
+    }
+    HwReading& operator+=(const HwReading& o) noexcept {
+      for (size_t i = 0; i < kHwEventCount; ++i) {
+        have[i] = have[i] || o.have[i];
+        value[i] += o.value[i];
+      }
+      return *this;
+    }
+  };
+
+  // triadc run-vm --hw-counters and triad_bench --hw-counters: the events
+  // above for this thread, user space only, through perf_event_open (Linux).
+  // Each event is opened on its own, so one the CPU or a container refuses
+  // (no PMU under most hypervisors, perf_event_paranoid, seccomp) only drops
+  // that event; reason() says why the first one failed.
+  class HwCounters {
+  public:
+    HwCounters() {
+#if defined(__linux__)
+      for (size_t i = 0; i < kHwEventCount; ++i) {
+        perf_event_attr attr{};
+        attr.size = sizeof attr;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        describe(HwEvent(i), attr);
+        fds_[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fds_[i] < 0 && reason_.empty()) reason_ = std::string(hw_event_name(HwEvent(i))) + ": " + std::strerror(errno);
+      }
+#else
+      reason_ = "perf_event_open is Linux only";
+#endif
+    }
+    ~HwCounters() {
+#if defined(__linux__)
+      for (int fd : fds_)
+        if (fd >= 0) ::close(fd);
+#endif
+    }
+
+    HwCounters(const HwCounters&) = delete;
+    HwCounters& operator=(const HwCounters&) = delete;
+
+    [[nodiscard]] bool any() const noexcept {
+      for (int fd : fds_)
+        if (fd >= 0) return true;
+      return false;
+    }
+    [[nodiscard]] const std::string& reason() const noexcept { return reason_; }
+
+    void start() noexcept {
+#if defined(__linux__)
+      for (int fd : fds_)
+        if (fd >= 0) {
+          ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+          ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    [[nodiscard]] HwReading stop() noexcept {
+      HwReading r;
+#if defined(__linux__)
+      for (int fd : fds_)
+        if (fd >= 0) ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      for (size_t i = 0; i < kHwEventCount; ++i) {
+        uint64_t v[3]; // value, time enabled, time running
+        if (fds_[i] < 0 || ::read(fds_[i], v, sizeof v) != ssize_t(sizeof v) || v[2] == 0) continue;
+        r.have[i] = true;
+        r.value[i] = double(v[0]) * (double(v[1]) / double(v[2]));
+      }
+#endif
+      return r;
+    }
+
+  private:
+    int fds_[kHwEventCount] = {-1, -1, -1, -1, -1, -1};
+    std::string reason_;
+
+#if defined(__linux__)
+    static void describe(HwEvent e, perf_event_attr& attr) {
+      const auto cache = [&](uint64_t id) {
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = id | (uint64_t(PERF_COUNT_HW_CACHE_OP_READ) << 8) | (uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+      };
+      attr.type = PERF_TYPE_HARDWARE;
+      switch (e) {
+        case HwEvent::Cycles: attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+        case HwEvent::Instructions: attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+        case HwEvent::BranchMisses: attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+        case HwEvent::L1dMisses: cache(PERF_COUNT_HW_CACHE_L1D); break;
+        case HwEvent::LlcMisses: cache(PERF_COUNT_HW_CACHE_LL); break;
+        case HwEvent::DtlbMisses: cache(PERF_COUNT_HW_CACHE_DTLB); break;
+      }
+    }
+#endif
+  };
+
+  // One line per counter read: the total and, given the number of bytecode
+  // instructions the VM executed, the count per instruction.
+  inline void write_hw_report(std::ostream& os, const HwReading& r, uint64_t executed) {
+    char line[128];
+    os << "[hw] " << executed << " bytecode instructions executed\n";
+    for (size_t i = 0; i < kHwEventCount; ++i) {
+      if (!r.have[i]) {
+        std::snprintf(line, sizeof line, "  %-14s %18s\n", hw_event_name(HwEvent(i)), "n/a");
+      } else {
+        std::snprintf(line, sizeof line, "  %-14s %18.0f %12.3f /instr\n", hw_event_name(HwEvent(i)), r.value[i],
+                      executed ? r.value[i] / double(executed) : 0.0);
+      }
+      os << line;
+    }
+    const size_t cyc = size_t(HwEvent::Cycles), ins = size_t(HwEvent::Instructions);
+    if (r.have[cyc] && r.have[ins] && r.value[cyc] > 0) {
+      std::snprintf(line, sizeof line, "  %-14s %18.2f\n", "IPC", r.value[ins] / r.value[cyc]);
+      os << line;
+    }
+  }
+
+} // namespace triad
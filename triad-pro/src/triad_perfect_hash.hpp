@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace triad {
+
+  // Compile-time perfect hashing for small fixed word sets (keywords, modes).
+  // The slot table and its seed are computed by the compiler, so a lookup is
+  // one hash over at most three characters plus a single comparison; nothing
+  // is lowercased into a temporary and nothing allocates.
+  namespace phash {
+
+    // ASCII-only case fold; identifiers never contain anything else.
+    constexpr char fold(char c) noexcept {
+      return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+    }
+
+    // Length plus folded first/middle/last characters, scrambled by `seed`.
+    // Cheap enough to run on every identifier; collisions are resolved by the
+    // seed search in Table, and false hits by the final comparison.
+    constexpr uint32_t hash(std::string_view s, uint32_t seed) noexcept {
+      const size_t n = s.size();
+      uint32_t h = static_cast<uint32_t>(n)
+                 | static_cast<uint32_t>(static_cast<unsigned char>(fold(s[0]))) << 8
+                 | static_cast<uint32_t>(static_cast<unsigned char>(fold(s[n / 2]))) << 16
+                 | static_cast<uint32_t>(static_cast<unsigned char>(fold(s[n - 1]))) << 24;
+      h ^= seed;
+      h *= 0x9E3779B1u;
+      h ^= h >> 15;
+      h *= 0x85EBCA77u;
+      h ^= h >> 13;
+      return h;
+    }
+
+    template <class V>
+    struct Word {
+      std::string_view text; // lowercase when foldCase is set
+      V value{};
+      bool foldCase = true;  // false: the word only matches with this exact case
+    };
+
+    template <class V, size_t N, size_t Slots>
+    class Table {
+      static_assert(N > 0 && N < Slots && Slots <= 256, "word set does not fit the slot table");
+      static_assert((Slots & (Slots - 1)) == 0, "slot count must be a power of two");
+
+      Word<V> words_[N]{};
+      uint8_t slots_[Slots]{}; // 0 = empty, otherwise index + 1 into words_
+      uint32_t seed_ = 0;
+      size_t minLen_ = ~size_t{0};
+      size_t maxLen_ = 0;
+
+    public:
+      constexpr explicit Table(const Word<V> (&words)[N]) {
+        for (size_t i = 0; i < N; ++i) {
+          words_[i] = words[i];
+          if (words[i].text.size() < minLen_) minLen_ = words[i].text.size();
+          if (words[i].text.size() > maxLen_) maxLen_ = words[i].text.size();
+        }
+        for (uint32_t seed = 1; seed < 4096; ++seed) {
+          if (place(seed)) { seed_ = seed; return; }
+        }
+      }
+
+      // False when no collision-free seed exists; check it with static_assert.
+      [[nodiscard]] constexpr bool found() const noexcept { return seed_ != 0; }
+
+      [[nodiscard]] constexpr V find(std::string_view s, V miss) const noexcept {
+        if (s.size() < minLen_ || s.size() > maxLen_) return miss;
+        const uint8_t at = slots_[hash(s, seed_) & (Slots - 1)];
+        if (at == 0) return miss;
+        const Word<V>& w = words_[at - 1];
+        if (w.text.size() != s.size()) return miss;
+        for (size_t i = 0; i < s.size(); ++i) {
+          if ((w.foldCase ? fold(s[i]) : s[i]) != w.text[i]) return miss;
+        }
+        return w.value;
+      }
+
+    private:
+      constexpr bool place(uint32_t seed) {
+        for (size_t i = 0; i < Slots; ++i) slots_[i] = 0;
+        for (size_t i = 0; i < N; ++i) {
+          uint8_t& slot = slots_[hash(words_[i].text, seed) & (Slots - 1)];
+          if (slot != 0) return false;
+          slot = static_cast<uint8_t>(i + 1);
+        }
+        return true;
+      }
+    };
+
+  } // namespace phash
+
+} // namespace triad
@@ -0,0 +1,299 @@
+#pragma once
+#include "triad_bytecode.hpp"
+#include "triad_profile.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <numeric>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace triad {
+
+  // A training run's profile, saved by `run-vm --profile-out` and read back
+  // by `--profile-use` to lay out the next compile of the same program:
+  //
+  //   triad-profile 1
+  //   code <instructions> <fingerprint>
+  //   runs <n>
+  //   block <ip> <times entered>
+  //   branch <ip> <taken> <fell through>
+  //   loop <header ip> <entries> <iterations>
+  //
+  // Everything is keyed by ip in the code as compiled, before layout, so the
+  // fingerprint of that code decides whether a profile still applies.
+  struct PgoProfile {
+    static constexpr int kVersion = 1;
+
+    uint64_t fingerprint = 0;
+    size_t codeSize = 0;
+    uint64_t runs = 0;
+    std::map<int, uint64_t> blocks;
+    std::map<int, std::pair<uint64_t, uint64_t>> branches;
+    std::map<int, std::pair<uint64_t, uint64_t>> loops;
+
+    [[nodiscard]] uint64_t block(int ip) const {
+      const auto it = blocks.find(ip);
+      return it == blocks.end() ? 0 : it->second;
+    }
+  };
+
+  struct PgoStats {
+    size_t blocks = 0;
+    size_t cold = 0;         // blocks never entered, moved after the hot code
+    size_t jumpsRemoved = 0; // JMPs to the block now laid out next
+    size_t jumpsAdded = 0;   // fall-throughs whose successor moved away
+  };
+
+  namespace pgo_detail {
+
+    inline bool is_cond_jump(Op op) noexcept {
+      return op == Op::IF_FALSE_JMP || op == Op::SC_AND_EVAL || op == Op::SC_OR_EVAL || op == Op::ITER_NEXT;
+    }
+    inline bool is_jump(Op op) noexcept { return op == Op::JMP || is_cond_jump(op); }
+
+    // The short-circuit ops and ITER_NEXT keep their target in `b`.
+    inline int& target(Instr& in) noexcept { return in.op == Op::JMP || in.op == Op::IF_FALSE_JMP ? in.a : in.b; }
+    inline int target(const Instr& in) noexcept { return in.op == Op::JMP || in.op == Op::IF_FALSE_JMP ? in.a : in.b; }
+
+    // First ip of every basic block, ascending, then code.size() for the exit.
+    // Empty when a jump leaves the code.
+    inline std::vector<int> leaders(const Chunk& ch) {
+      const int n = static_cast<int>(ch.code.size());
+      std::vector<char> starts(n + 1, 0);
+      starts[0] = 1;
+      for (int ip = 0; ip < n; ++ip) {
+        const Instr& in = ch.code[ip];
+        if (is_jump(in.op)) {
+          const int t = target(in);
+          if (t < 0 || t > n) return {};
+          starts[t] = 1;
+        }
+        if (is_jump(in.op) || in.op == Op::RET) starts[ip + 1] = 1;
+      }
+      std::vector<int> out;
+      for (int ip = 0; ip < n; ++ip)
+        if (starts[ip]) out.push_back(ip);
+      out.push_back(n);
+      return out;
+    }
+
+  } // namespace pgo_detail
+
+  // Block, branch and loop counts from one counted run of `ch`.
+  [[nodiscard]] inline PgoProfile make_profile(const Chunk& ch, const ProfileData& data) {
+    PgoProfile p;
+    p.fingerprint = code_fingerprint(ch);
+    p.codeSize = ch.code.size();
+    p.runs = 1;
+    const auto count = [&](size_t ip) { return ip < data.exec_counts.size() ? data.exec_counts[ip] : 0; };
+    const auto taken = [&](size_t ip) { return ip < data.taken_counts.size() ? data.taken_counts[ip] : 0; };
+
+    const std::vector<int> starts = pgo_detail::leaders(ch);
+    for (size_t i = 0; i + 1 < starts.size(); ++i)
+      if (const uint64_t n = count(starts[i])) p.blocks[starts[i]] = n;
+
+    for (size_t ip = 0; ip < ch.code.size(); ++ip) {
+      const Instr& in = ch.code[ip];
+      const uint64_t n = count(ip);
+      if (!n) continue;
+      if (pgo_detail::is_cond_jump(in.op)) {
+        p.branches[static_cast<int>(ip)] = {taken(ip), n - taken(ip)};
+      } else if (in.op == Op::JMP && static_cast<size_t>(in.a) <= ip) {
+        // A back edge: its header was entered once per iteration plus once
+        // per time the loop was reached from outside.
+        auto& loop = p.loops[in.a];
+        const uint64_t header = count(in.a);
+        loop.first += header > n ? header - n : 0;
+        loop.second += n;
+      }
+    }
+    return p;
+  }
+
+  // Accumulate another run of the same code into `into`.
+  inline void merge_profile(PgoProfile& into, const PgoProfile& from) {
+    if (into.fingerprint != from.fingerprint) throw std::runtime_error("cannot merge profiles of different code");
+    into.runs += from.runs;
+    for (const auto& [ip, n] : from.blocks) into.blocks[ip] += n;
+    for (const auto& [ip, b] : from.branches) {
+      into.branches[ip].first += b.first;
+      into.branches[ip].second += b.second;
+    }
+    for (const auto& [ip, l] : from.loops) {
+      into.loops[ip].first += l.first;
+      into.loops[ip].second += l.second;
+    }
+  }
+
+  inline void write_profile(std::ostream& os, const PgoProfile& p) {
+    os << "triad-profile " << PgoProfile::kVersion << "\n"
+       << "code " << p.codeSize << " " << std::hex << p.fingerprint << std::dec << "\n"
+       << "runs " << p.runs << "\n";
+    for (const auto& [ip, n] : p.blocks) os << "block " << ip << " " << n << "\n";
+    for (const auto& [ip, b] : p.branches) os << "branch " << ip << " " << b.first << " " << b.second << "\n";
+    for (const auto& [ip, l] : p.loops) os << "loop " << ip << " " << l.first << " " << l.second << "\n";
+  }
+
+  [[nodiscard]] inline PgoProfile read_profile(std::istream& is) {
+    PgoProfile p;
+    std::string line;
+    int version = 0;
+    size_t lineNo = 0;
+    const auto bad = [&](const char* why) {
+      return std::runtime_error("Bad profile (line " + std::to_string(lineNo) + "): " + why);
+    };
+    while (std::getline(is, line)) {
+      ++lineNo;
+      std::istringstream in(line);
+      std::string key;
+      if (!(in >> key)) continue;
+      if (lineNo == 1) {
+        if (key != "triad-profile" || !(in >> version)) throw bad("not a triad profile");
+        if (version != PgoProfile::kVersion)
+          throw std::runtime_error("Profile version " + std::to_string(version) + " is not supported (expected " +
+                                   std::to_string(PgoProfile::kVersion) + ")");
+        continue;
+      }
+      int ip = 0;
+      uint64_t x = 0, y = 0;
+      if (key == "code") {
+        if (!(in >> p.codeSize >> std::hex >> p.fingerprint)) throw bad("expected code <size> <fingerprint>");
+      } else if (key == "runs") {
+        if (!(in >> p.runs)) throw bad("expected runs <n>");
+      } else if (key == "block") {
+        if (!(in >> ip >> x)) throw bad("expected block <ip> <count>");
+        p.blocks[ip] += x;
+      } else if (key == "branch") {
+        if (!(in >> ip >> x >> y)) throw bad("expected branch <ip> <taken> <fell through>");
+        p.branches[ip] = {x, y};
+      } else if (key == "loop") {
+        if (!(in >> ip >> x >> y)) throw bad("expected loop <ip> <entries> <iterations>");
+        p.loops[ip] = {x, y};
+      } else {
+        throw bad("unknown record");
+      }
+    }
+    if (version == 0) throw std::runtime_error("Bad profile: empty");
+    return p;
+  }
+
+  // Re-lay out `ch`'s basic blocks from a profile of the same code. Hot
+  // edges become fall-throughs, heaviest first (Pettis-Hansen chaining): a
+  // JMP whose target now follows it is dropped, so an if whose then-branch
+  // is the hot one no longer jumps over its else on every pass. Blocks the
+  // training run never entered go after all the hot code. Conditional jumps
+  // keep their fall-through successor (there is no inverted form); when that
+  // block moved, a JMP to it is added on that, now colder, path.
+  inline PgoStats apply_pgo(Chunk& ch, const PgoProfile& prof) {
+    using namespace pgo_detail;
+    if (prof.fingerprint != code_fingerprint(ch) || prof.codeSize != ch.code.size())
+      throw std::runtime_error("profile was recorded for different code");
+
+    PgoStats stats;
+    const std::vector<int> starts = leaders(ch);
+    if (starts.size() < 3 || prof.blocks.empty()) return stats; // nothing to reorder
+    const int nb = static_cast<int>(starts.size()) - 1; // block nb is the exit
+    stats.blocks = nb;
+
+    std::vector<int> blockOf(ch.code.size() + 1);
+    for (int b = 0; b <= nb; ++b)
+      for (int ip = starts[b]; ip < (b < nb ? starts[b + 1] : starts[b] + 1); ++ip) blockOf[ip] = b;
+    const auto count = [&](int b) { return prof.block(starts[b]); };
+    const auto lastOf = [&](int b) -> const Instr& { return ch.code[starts[b + 1] - 1]; };
+
+    // Edges that may become fall-throughs: into the next block unless the
+    // block ends in JMP or RET, and the target of a JMP.
+    struct Edge {
+      uint64_t weight;
+      int from, to;
+    };
+    std::vector<Edge> edges;
+    for (int b = 0; b < nb; ++b) {
+      const Instr& last = lastOf(b);
+      if (last.op == Op::RET) continue;
+      if (last.op == Op::JMP) {
+        edges.push_back({count(b), b, blockOf[last.a]});
+        continue;
+      }
+      uint64_t w = count(b);
+      if (is_cond_jump(last.op)) {
+        const auto it = prof.branches.find(starts[b + 1] - 1);
+        w = it == prof.branches.end() ? 0 : it->second.second;
+      }
+      edges.push_back({w, b, b + 1});
+    }
+    std::stable_sort(edges.begin(), edges.end(), [](const Edge& x, const Edge& y) { return x.weight > y.weight; });
+
+    std::vector<int> next(nb, -1), prev(nb, -1), chain(nb);
+    std::iota(chain.begin(), chain.end(), 0);
+    const auto find = [&](int b) {
+      while (chain[b] != b) b = chain[b] = chain[chain[b]];
+      return b;
+    };
+    for (const Edge& e : edges) {
+      if (e.to >= nb || e.to == 0 || next[e.from] != -1 || prev[e.to] != -1) continue;
+      if (e.weight == 0 && (count(e.from) || count(e.to))) continue; // keep cold code out of hot chains
+      const int a = find(e.from), z = find(e.to);
+      if (a == z) continue;
+      next[e.from] = e.to;
+      prev[e.to] = e.from;
+      chain[z] = a;
+    }
+
+    // The entry chain, then the others hot before cold, each in source order.
+    std::vector<int> heads;
+    for (int b = 1; b < nb; ++b)
+      if (prev[b] == -1) heads.push_back(b);
+    std::stable_partition(heads.begin(), heads.end(), [&](int b) { return count(b) != 0; });
+    heads.insert(heads.begin(), 0);
+    std::vector<int> order;
+    for (int h : heads)
+      for (int b = h; b != -1; b = next[b]) order.push_back(b);
+    for (int b = 0; b < nb; ++b) stats.cold += count(b) == 0 ? 1 : 0;
+
+    const std::vector<uint32_t> offs = ch.lines.expand(ch.code.size());
+    std::vector<Instr> code;
+    std::vector<uint32_t> codeOffs;
+    std::vector<std::pair<size_t, int>> fixups; // new ip of a jump, target block
+    std::vector<int> newStart(nb + 1);
+    code.reserve(ch.code.size() + nb);
+    for (size_t k = 0; k < order.size(); ++k) {
+      const int b = order[k];
+      const int following = k + 1 < order.size() ? order[k + 1] : nb;
+      newStart[b] = static_cast<int>(code.size());
+      for (int ip = starts[b]; ip < starts[b + 1]; ++ip) {
+        const Instr& in = ch.code[ip];
+        if (in.op == Op::JMP && blockOf[in.a] == following) {
+          ++stats.jumpsRemoved;
+          continue;
+        }
+        if (is_jump(in.op)) fixups.emplace_back(code.size(), blockOf[target(in)]);
+        code.push_back(in);
+        codeOffs.push_back(offs[ip]);
+      }
+      const Instr& last = lastOf(b);
+      if (last.op != Op::JMP && last.op != Op::RET && b + 1 != following) {
+        fixups.emplace_back(code.size(), b + 1);
+        code.push_back({Op::JMP});
+        codeOffs.push_back(offs[starts[b + 1] - 1]);
+        ++stats.jumpsAdded;
+      }
+    }
+    newStart[nb] = static_cast<int>(code.size());
+    for (const auto& [ip, b] : fixups) target(code[ip]) = newStart[b];
+
+    LineTable lines;
+    for (size_t ip = 0; ip < code.size(); ++ip)
+      if (codeOffs[ip] != LineTable::kNone) lines.mark(static_cast<int>(ip), codeOffs[ip]);
+    ch.code = std::move(code);
+    ch.lines = std::move(lines);
+    return stats;
+  }
+
+} // namespace triad
@@ -0,0 +1,160 @@
+#pragma once
+#include "triad_alloc.hpp"
+#include "triad_timeline.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <exception>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+namespace triad {
+
+  // triadc --time-phases. Wall and CPU time, allocations (AllocCounter, all
+  // threads) and the process's RSS high-water mark at the end of each
+  // compiler phase or pass. The high-water mark only grows: a phase that
+  // raised it is the one that needed the memory. Disabled, time() just
+  // runs the phase.
+  class PhaseTimes {
+  public:
+    struct Phase {
+      std::string name;
+      double wallMs = 0, cpuMs = 0;
+      uint64_t allocs = 0, allocBytes = 0;
+      long peakRssKb = 0; // 0 where getrusage is unavailable
+    };
+
+    explicit PhaseTimes(bool enabled = false) noexcept : enabled_(enabled) {
+      if (enabled_) AllocCounter::enabled.store(true, std::memory_order_relaxed);
+    }
+    ~PhaseTimes() {
+      if (enabled_) AllocCounter::enabled.store(false, std::memory_order_relaxed);
+    }
+
+    PhaseTimes(const PhaseTimes&) = delete;
+    PhaseTimes& operator=(const PhaseTimes&) = delete;
+
+    [[nodiscard]] bool enabled() const noexcept { return enabled_; }
+    [[nodiscard]] const std::vector<Phase>& phases() const noexcept { return phases_; }
+
+    // Run `body` as the next phase and return what it returns. A phase that
+    // throws is not recorded.
+    template <class F>
+    decltype(auto) time(const char* name, F&& body) {
+      if (!enabled_) return body();
+      TimelineSpan span("compile", name);
+      const Mark start = mark();
+      struct Record {
+        PhaseTimes& self;
+        const char* name;
+        const Mark& start;
+        int uncaught = std::uncaught_exceptions();
+        ~Record() {
+          if (std::uncaught_exceptions() == uncaught) self.record(name, start, mark());
+        }
+      } record{*this, name, start};
+      return body();
+    }
+
+    void write_table(std::ostream& os) const {
+      char line[128];
+      std::snprintf(line, sizeof line, "%-24s %10s %10s %10s %14s %12s\n", "phase", "wall ms", "cpu ms", "allocs",
+                    "alloc bytes", "peak RSS kB");
+      os << line;
+      const auto row = [&](const Phase& p) {
+        std::snprintf(line, sizeof line, "%-24s %10.3f %10.3f %10llu %14llu %12ld\n", p.name.c_str(), p.wallMs, p.cpuMs,
+                      (unsigned long long)p.allocs, (unsigned long long)p.allocBytes, p.peakRssKb);
+        os << line;
+      };
+      for (const Phase& p : phases_) row(p);
+      row(total());
+    }
+
+    // {"version": 1, "compiler": ..., "source": ..., "bytes": ...,
+    //  "phases": [...], "total": {...}}, one object per phase.
+    void write_json(std::ostream& os, const std::string& compiler, const std::string& source, size_t bytes) const {
+      using timeline_detail::json_string;
+      const auto obj = [&](const Phase& p) {
+        char buf[64];
+        os << "{\"name\": " << json_string(p.name);
+        std::snprintf(buf, sizeof buf, "%.3f", p.wallMs);
+        os << ", \"wall_ms\": " << buf;
+        std::snprintf(buf, sizeof buf, "%.3f", p.cpuMs);
+        os << ", \"cpu_ms\": " << buf << ", \"allocs\": " << p.allocs << ", \"alloc_bytes\": " << p.allocBytes
+           << ", \"peak_rss_kb\": " << p.peakRssKb << "}";
+      };
+      os << "{\n  \"version\": 1,\n  \"compiler\": " << json_string(compiler) << ",\n  \"source\": " << json_string(source)
+         << ",\n  \"bytes\": " << bytes << ",\n  \"phases\": [\n";
+      for (size_t i = 0; i < phases_.size(); ++i) {
+        os << "    ";
+        obj(phases_[i]);
+        os << (i + 1 < phases_.size() ? ",\n" : "\n");
+      }
+      os << "  ],\n  \"total\": ";
+      obj(total());
+      os << "\n}\n";
+    }
+
+  private:
+    struct Mark {
+      std::chrono::steady_clock::time_point wall;
+      std::clock_t cpu;
+      uint64_t allocs, allocBytes;
+    };
+
+    bool enabled_;
+    std::vector<Phase> phases_;
+
+    static Mark mark() noexcept {
+      return {std::chrono::steady_clock::now(), std::clock(), AllocCounter::count.load(std::memory_order_relaxed),
+              AllocCounter::bytes.load(std::memory_order_relaxed)};
+    }
+
+    static long peak_rss_kb() noexcept {
+#if defined(_WIN32)
+      return 0;
+#else
+      rusage ru{};
+      if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+#if defined(__APPLE__)
+      return ru.ru_maxrss / 1024; // bytes there
+#else
+      return ru.ru_maxrss;
+#endif
+#endif
+    }
+
+    void record(const char* name, const Mark& a, const Mark& b) {
+      Phase p;
+      p.name = name;
+      p.wallMs = std::chrono::duration<double, std::milli>(b.wall - a.wall).count();
+      p.cpuMs = 1000.0 * double(b.cpu - a.cpu) / CLOCKS_PER_SEC;
+      p.allocs = b.allocs - a.allocs;
+      p.allocBytes = b.allocBytes - a.allocBytes;
+      p.peakRssKb = peak_rss_kb();
+      phases_.push_back(std::move(p));
+    }
+
+    [[nodiscard]] Phase total() const {
+      Phase t;
+      t.name = "total";
+      for (const Phase& p : phases_) {
+        t.wallMs += p.wallMs;
+        t.cpuMs += p.cpuMs;
+        t.allocs += p.allocs;
+        t.allocBytes += p.allocBytes;
+        t.peakRssKb = std::max(t.peakRssKb, p.peakRssKb);
+      }
+      return t;
+    }
+  };
+
+} // namespace triad
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace triad {
+
+  // Table-driven precedence climbing for binary operators, shared by the
+  // bytecode parser (triad_parser.cpp) and the AST parser in triad_min.cpp.
+  // A front end lists its operators once, keyed by its own token kind; climb()
+  // then needs one table lookup per operator, and nests only for precedence
+  // steps the input actually takes rather than once per level per operand.
+  namespace pratt {
+
+    template <class Op>
+    struct Binding {
+      uint8_t prec = 0; // 0: not an infix operator; higher binds tighter
+      Op op{};
+    };
+
+    template <class Kind, class Op>
+    struct Rule {
+      Kind kind;
+      uint8_t prec;
+      Op op;
+    };
+
+    // Bindings indexed by token kind; `Kinds` is the number of kinds.
+    template <class Kind, class Op, size_t Kinds>
+    class BindingTable {
+      Binding<Op> slots_[Kinds]{};
+      Binding<Op> none_{};
+
+    public:
+      template <size_t N>
+      constexpr explicit BindingTable(const Rule<Kind, Op> (&rules)[N]) {
+        for (size_t i = 0; i < N; ++i) slots_[static_cast<size_t>(rules[i].kind)] = {rules[i].prec, rules[i].op};
+      }
+
+      [[nodiscard]] constexpr const Binding<Op>& operator[](Kind k) const noexcept {
+        const size_t i = static_cast<size_t>(k);
+        return i < Kinds ? slots_[i] : none_;
+      }
+    };
+
+    // Result type for parsers that emit code instead of building a tree.
+    struct None {};
+
+    // Parse operands joined by operators that bind at least `minPrec`; all
+    // operators are left-associative. The parser provides:
+    //   peek_kind()          kind of the next token
+    //   skip()               consume it (the operator)
+    //   operand()            a unary or primary expression
+    //   infix(lhs, op, rhs)  combine; calling rhs() parses the right operand
+    template <class Table, class Parser>
+    auto climb(const Table& table, Parser& p, unsigned minPrec = 1) {
+      auto lhs = p.operand();
+      for (;;) {
+        const auto& b = table[p.peek_kind()];
+        if (b.prec < minPrec) return lhs;
+        p.skip();
+        const unsigned next = b.prec + 1u;
+        lhs = p.infix(std::move(lhs), b.op, [&] { return climb(table, p, next); });
+      }
+    }
+
+  } // namespace pratt
+
+} // namespace triad
@@ -0,0 +1,234 @@
+#pragma once
+#include "triad_bytecode.hpp"
+#include "triad_lineindex.hpp"
+#include "triad_number.hpp"
+#include <algorithm>
+#include <csignal>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/time.h>
+#endif
+
+namespace triad {
+
+  namespace profile_detail {
+
+    // "line N: <statement text>".
+    inline std::string frame(std::string_view src, const LineIndex& index, uint32_t off) {
+      if (off == LineTable::kNone) return "(no line)";
+      if (src.empty()) return "offset " + std::to_string(off);
+      const LineCol lc = index.at(off);
+      std::string_view text = src.substr(off - (lc.col - 1));
+      text = text.substr(0, std::min(text.find('\n'), size_t(60)));
+      while (!text.empty() && (text.back() == '\r' || text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+      while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+      return "line " + std::to_string(lc.line) + ": " + std::string(text);
+    }
+
+    // "ADD", "PUSH_CONST 3.5", "JMP -> 17", "CALL_METHOD norm/1".
+    inline std::string disasm(const Chunk& ch, const Instr& in) {
+      std::ostringstream os;
+      os << op_name(in.op);
+      switch (in.op) {
+        case Op::PUSH_CONST:
+          if (in.a >= 0 && size_t(in.a) < ch.consts.size()) {
+            const Value& v = ch.consts[in.a];
+            if (v.tag == Value::Num) os << " " << number_to_string(v.num);
+            else os << " \"" << v.str.substr(0, 24) << (v.str.size() > 24 ? "...\"" : "\"");
+          }
+          break;
+        case Op::PUSH_VAR: case Op::SET_VAR: case Op::GET_FIELD: case Op::NEW_CLASS:
+          if (in.a >= 0 && size_t(in.a) < ch.names.size()) os << " " << ch.names[in.a];
+          break;
+        case Op::CALL_METHOD:
+          if (in.a >= 0 && size_t(in.a) < ch.names.size()) os << " " << ch.names[in.a] << "/" << in.b;
+          break;
+        case Op::MAKE_TUPLE:
+          os << " " << in.a;
+          break;
+        case Op::JMP: case Op::IF_FALSE_JMP:
+          os << " -> " << in.a;
+          break;
+        case Op::SC_AND_EVAL: case Op::SC_OR_EVAL:
+          os << " -> " << in.b;
+          break;
+        case Op::ITER_OPEN:
+          os << " " << (in.b == kIterStdin ? "stdin" : in.b == kIterLines ? "lines" : "split") << " #" << in.a;
+          break;
+        case Op::ITER_NEXT:
+          if (in.a >= 0 && size_t(in.a) < ch.names.size()) os << " " << ch.names[in.a];
+          os << " #" << in.c << " -> " << in.b;
+          break;
+        default:
+          break;
+      }
+      return os.str();
+    }
+
+  } // namespace profile_detail
+
+  // triadc run-vm --profile. Exact execution counts, one flat counter per
+  // instruction, filled by the VM's counting dispatch loop (VM::count_into);
+  // the uncounted loop is a separate instantiation and pays nothing. Counts
+  // per opcode are summed from these when the report is written.
+  struct ProfileData {
+    std::vector<uint64_t> exec_counts;  // by ip
+    std::vector<uint64_t> taken_counts; // by ip: conditional jumps taken (triad_pgo.hpp)
+
+    [[nodiscard]] uint64_t total() const noexcept {
+      uint64_t n = 0;
+      for (uint64_t c : exec_counts) n += c;
+      return n;
+    }
+  };
+
+  // The `top` most executed instructions with their disassembly and source
+  // line, then every opcode that ran, most frequent first.
+  inline void write_report(std::ostream& os, const ProfileData& data, const Chunk& ch, std::string_view src, size_t top = 20) {
+    const uint64_t total = data.total();
+    const auto pct = [&](uint64_t n) {
+      std::ostringstream s;
+      s << std::fixed << std::setprecision(1) << (total ? 100.0 * double(n) / double(total) : 0.0) << "%";
+      return s.str();
+    };
+    os << "[profile] " << total << " instructions executed\n";
+
+    const size_t n = std::min(data.exec_counts.size(), ch.code.size());
+    std::vector<size_t> hot;
+    for (size_t ip = 0; ip < n; ++ip)
+      if (data.exec_counts[ip]) hot.push_back(ip);
+    top = std::min(top, hot.size());
+    std::partial_sort(hot.begin(), hot.begin() + top, hot.end(), [&](size_t a, size_t b) {
+      return data.exec_counts[a] != data.exec_counts[b] ? data.exec_counts[a] > data.exec_counts[b] : a < b;
+    });
+
+    const std::vector<uint32_t> offs = ch.lines.expand(ch.code.size());
+    const LineIndex index(src);
+    os << "\nHottest instructions:\n"
+       << std::setw(14) << "count" << std::setw(8) << "%" << std::setw(7) << "ip" << "  "
+       << std::left << std::setw(28) << "instruction" << std::right << "source\n";
+    for (size_t i = 0; i < top; ++i) {
+      const size_t ip = hot[i];
+      os << std::setw(14) << data.exec_counts[ip] << std::setw(8) << pct(data.exec_counts[ip]) << std::setw(7) << ip << "  "
+         << std::left << std::setw(28) << profile_detail::disasm(ch, ch.code[ip]) << std::right
+         << profile_detail::frame(src, index, offs[ip]) << "\n";
+    }
+
+    uint64_t byOp[kOpCount] = {};
+    for (size_t ip = 0; ip < n; ++ip) {
+      const size_t op = size_t(ch.code[ip].op);
+      if (op < kOpCount) byOp[op] += data.exec_counts[ip];
+    }
+    std::vector<size_t> ops;
+    for (size_t op = 0; op < kOpCount; ++op)
+      if (byOp[op]) ops.push_back(op);
+    std::sort(ops.begin(), ops.end(), [&](size_t a, size_t b) { return byOp[a] != byOp[b] ? byOp[a] > byOp[b] : a < b; });
+    os << "\nOpcodes:\n";
+    for (size_t op : ops)
+      os << "  " << std::left << std::setw(14) << op_name(Op(op)) << std::right << std::setw(14) << byOp[op]
+         << std::setw(8) << pct(byOp[op]) << "\n";
+  }
+
+  // triadc --profile=sample. Every `intervalUs` of CPU time SIGPROF
+  // interrupts the VM and the handler counts the instruction it was at (the
+  // VM publishes it, VM::publish_ip). One counter per instruction keeps the
+  // handler to a single increment and the memory fixed however long the run;
+  // the counts are mapped to source lines through Chunk::lines afterwards.
+  class SampleProfiler {
+  public:
+    volatile std::sig_atomic_t ip = -1; // written by the VM
+
+    explicit SampleProfiler(const Chunk& ch) : ch_(ch), hits_(ch.code.size(), 0) {}
+    ~SampleProfiler() { stop(); }
+
+    SampleProfiler(const SampleProfiler&) = delete;
+    SampleProfiler& operator=(const SampleProfiler&) = delete;
+
+    void start(long intervalUs = 1000) {
+#if defined(_WIN32)
+      (void)intervalUs;
+      throw std::runtime_error("--profile=sample needs setitimer (POSIX)");
+#else
+      if (active_) throw std::runtime_error("a sampling profiler is already running");
+      active_ = this;
+      struct sigaction sa{};
+      sa.sa_handler = &SampleProfiler::on_signal;
+      sigemptyset(&sa.sa_mask);
+      sa.sa_flags = SA_RESTART;
+      sigaction(SIGPROF, &sa, &previous_);
+      itimerval tv{};
+      tv.it_interval.tv_sec = intervalUs / 1000000;
+      tv.it_interval.tv_usec = intervalUs % 1000000;
+      tv.it_value = tv.it_interval;
+      setitimer(ITIMER_PROF, &tv, nullptr);
+#endif
+    }
+
+    void stop() {
+#if !defined(_WIN32)
+      if (active_ != this) return;
+      itimerval off{};
+      setitimer(ITIMER_PROF, &off, nullptr);
+      sigaction(SIGPROF, &previous_, nullptr);
+      active_ = nullptr;
+#endif
+    }
+
+    // Samples taken in the VM, and while it was not running an instruction.
+    [[nodiscard]] uint64_t samples() const noexcept {
+      uint64_t n = 0;
+      for (uint32_t h : hits_) n += h;
+      return n;
+    }
+    [[nodiscard]] uint64_t outside() const noexcept { return outside_; }
+
+    // Folded stacks for flamegraph.pl, one per source line and per method
+    // called or class created on it:
+    //   capsule;line 12: say p.norm();method norm 42
+    // `src` is the text the chunk was compiled from; without it frames name
+    // byte offsets.
+    void write_folded(std::ostream& os, std::string_view src, const std::string& capsule) const {
+      const std::vector<uint32_t> offs = ch_.lines.expand(ch_.code.size());
+      const LineIndex index(src);
+      std::map<std::string, uint64_t> stacks;
+      for (size_t i = 0; i < hits_.size(); ++i) {
+        if (!hits_[i]) continue;
+        std::string line = profile_detail::frame(src, index, offs[i]);
+        std::replace(line.begin(), line.end(), ';', ','); // ';' separates frames
+        std::string stack = capsule + ";" + line;
+        const Instr& in = ch_.code[i];
+        if (in.op == Op::CALL_METHOD) stack += ";method " + ch_.names[in.a];
+        else if (in.op == Op::NEW_CLASS) stack += ";new " + ch_.names[in.a];
+        stacks[stack] += hits_[i];
+      }
+      for (const auto& [stack, n] : stacks) os << stack << " " << n << "\n";
+    }
+
+  private:
+    const Chunk& ch_;
+    std::vector<uint32_t> hits_;
+    uint64_t outside_ = 0;
+#if !defined(_WIN32)
+    struct sigaction previous_{};
+#endif
+    static inline SampleProfiler* active_ = nullptr;
+
+    static void on_signal(int) {
+      SampleProfiler* p = active_;
+      if (!p) return;
+      const std::sig_atomic_t at = p->ip;
+      if (at >= 0 && static_cast<size_t>(at) < p->hits_.size()) ++p->hits_[at];
+      else ++p->outside_;
+    }
+  };
+
+} // namespace triad
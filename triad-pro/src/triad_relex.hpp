@@ -0,0 +1,110 @@
+#pragma once
+#include "triad_lexer.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+namespace triad {
+
+  // One replacement in a document: `removed` bytes at `off` (old text) were
+  // replaced by `inserted` bytes.
+  struct TextEdit {
+    size_t off = 0;
+    size_t removed = 0;
+    size_t inserted = 0;
+  };
+
+  // The single edit that turns `before` into `after`: common prefix and
+  // suffix are left alone. This is what a file watcher sees on save.
+  [[nodiscard]] inline TextEdit edit_between(std::string_view before, std::string_view after) noexcept {
+    const size_t most = std::min(before.size(), after.size());
+    size_t pre = 0;
+    while (pre < most && before[pre] == after[pre]) ++pre;
+    size_t suf = 0;
+    while (suf < most - pre && before[before.size() - 1 - suf] == after[after.size() - 1 - suf]) ++suf;
+    return {pre, before.size() - pre - suf, after.size() - pre - suf};
+  }
+
+  // Which tokens an edit replaced: old [first, oldLast) became new [first, last).
+  // Everything before `first` is untouched; everything after moved by
+  // last - oldLast positions and by the edit's size in bytes.
+  struct TokenDelta {
+    size_t first = 0;
+    size_t oldLast = 0;
+    size_t last = 0;
+  };
+
+  // v[first, last) = [from, to), without moving the tail when the sizes match
+  // (the usual case: an edit inside one token or statement).
+  template <class T, class It>
+  void replace_range(std::vector<T>& v, size_t first, size_t last, It from, It to) {
+    const size_t n = static_cast<size_t>(std::distance(from, to));
+    auto at = v.begin() + static_cast<std::ptrdiff_t>(first);
+    if (n == last - first) {
+      std::copy(from, to, at);
+      return;
+    }
+    at = v.erase(at, v.begin() + static_cast<std::ptrdiff_t>(last));
+    v.insert(at, from, to);
+  }
+
+  namespace relex_detail {
+
+    // Bytes the lexer may read past the end of a token (see TokenStream::kSlack).
+    constexpr size_t kLookahead = 2;
+
+    // Where the lexer stood after the token: a string's closing quote is
+    // not part of the token but was consumed with it.
+    inline size_t lex_end(const Token& t) noexcept {
+      return t.off + t.len + (t.kind == TokKind::Str ? 1 : 0);
+    }
+
+  } // namespace relex_detail
+
+  // Bring `toks`, the full token list (Eof included) of the old text, up to
+  // date with `src`, the text after edit `e`. Lexing restarts at the first
+  // token that could have seen the edited bytes and stops as soon as it lands
+  // on the start of an old token past the edit: the lexer carries no state
+  // between tokens, so from there on the old tokens are still right and only
+  // their offsets move. On a lex error `toks` is left as it was.
+  inline TokenDelta relex(std::vector<Token>& toks, std::string_view src, const TextEdit& e) {
+    using relex_detail::lex_end;
+    if (toks.empty()) {
+      toks = Lexer(src).run();
+      return {0, 0, toks.size()};
+    }
+
+    const size_t first = static_cast<size_t>(std::partition_point(toks.begin(), toks.end(), [&](const Token& t) {
+      return lex_end(t) + relex_detail::kLookahead <= e.off;
+    }) - toks.begin());
+    const size_t restart = first ? lex_end(toks[first - 1]) : 0;
+    const size_t oldEnd = e.off + e.removed;
+    const size_t newEnd = e.off + e.inserted;
+    const uint32_t shift = static_cast<uint32_t>(e.inserted - e.removed); // wraps for deletions
+
+    Lexer lx(src);
+    lx.reset({restart});
+    std::vector<Token> fresh;
+    size_t old = first;
+    for (;;) {
+      const Token t = lx.next();
+      if (t.off >= newEnd) {
+        const uint32_t was = t.off - shift;
+        while (old < toks.size() && toks[old].off < was) ++old;
+        if (old < toks.size() && toks[old].off == was && was >= oldEnd && toks[old].kind == t.kind) break;
+      }
+      fresh.push_back(t);
+      if (t.kind == TokKind::Eof) { old = toks.size(); break; }
+    }
+
+    if (shift != 0) {
+      for (size_t i = old; i < toks.size(); ++i) toks[i].off += shift;
+    }
+    replace_range(toks, first, old, fresh.begin(), fresh.end());
+    return {first, old, first + fresh.size()};
+  }
+
+} // namespace triad
@@ -0,0 +1,220 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Block scanners for the lexer's hot loops: whitespace runs, comment bodies,
+// string bodies and identifier runs. Each function returns the first byte in
+// [p, end) that stops the run (or `end`), checking 32 bytes per step with
+// AVX2, 16 with SSE2, and one at a time otherwise. The ISA is chosen at
+// compile time; define TRIAD_SCAN_SCALAR to force the portable path.
+#if !defined(TRIAD_SCAN_SCALAR)
+#  if defined(__AVX2__)
+#    include <immintrin.h>
+#    define TRIAD_SCAN_AVX2 1
+#    define TRIAD_SCAN_SSE2 1
+#  elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define TRIAD_SCAN_SSE2 1
+#  endif
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+#  include <intrin.h>
+#endif
+
+namespace triad {
+namespace scan {
+
+  namespace detail {
+
+    inline unsigned ctz(uint32_t m) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+      unsigned long i; _BitScanForward(&i, m); return static_cast<unsigned>(i);
+#else
+      return static_cast<unsigned>(__builtin_ctz(m));
+#endif
+    }
+
+    inline unsigned clz(uint32_t m) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+      unsigned long i; _BitScanReverse(&i, m); return 31u - static_cast<unsigned>(i);
+#else
+      return static_cast<unsigned>(__builtin_clz(m));
+#endif
+    }
+
+    inline unsigned popcount(uint32_t m) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+      return static_cast<unsigned>(__popcnt(m));
+#else
+      return static_cast<unsigned>(__builtin_popcount(m));
+#endif
+    }
+
+    constexpr bool is_space(char c) noexcept { return c == ' ' || (c >= '\t' && c <= '\r'); }
+    constexpr bool is_blank(char c) noexcept { return c == ' ' || c == '\t'; }
+    constexpr bool is_ident(char c) noexcept {
+      return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+#if defined(TRIAD_SCAN_AVX2)
+    struct V256 {
+      using reg = __m256i;
+      static constexpr size_t width = 32;
+      static constexpr uint32_t full = 0xFFFFFFFFu;
+      static reg load(const char* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+      static reg splat(char c) noexcept { return _mm256_set1_epi8(c); }
+      static reg eq(reg v, char c) noexcept { return _mm256_cmpeq_epi8(v, splat(c)); }
+      static reg either(reg a, reg b) noexcept { return _mm256_or_si256(a, b); }
+      // lo <= v <= hi, via a biased signed compare (there is no unsigned one).
+      static reg range(reg v, char lo, char hi) noexcept {
+        reg biased = _mm256_add_epi8(v, splat(static_cast<char>(0x80 - lo)));
+        return _mm256_cmpgt_epi8(splat(static_cast<char>(0x80 + (hi - lo) + 1)), biased);
+      }
+      static reg fold(reg v) noexcept { return _mm256_or_si256(v, splat(0x20)); }
+      static uint32_t mask(reg v) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(v)); }
+    };
+#endif
+
+#if defined(TRIAD_SCAN_SSE2)
+    struct V128 {
+      using reg = __m128i;
+      static constexpr size_t width = 16;
+      static constexpr uint32_t full = 0xFFFFu;
+      static reg load(const char* p) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+      static reg splat(char c) noexcept { return _mm_set1_epi8(c); }
+      static reg eq(reg v, char c) noexcept { return _mm_cmpeq_epi8(v, splat(c)); }
+      static reg either(reg a, reg b) noexcept { return _mm_or_si128(a, b); }
+      static reg range(reg v, char lo, char hi) noexcept {
+        reg biased = _mm_add_epi8(v, splat(static_cast<char>(0x80 - lo)));
+        return _mm_cmplt_epi8(biased, splat(static_cast<char>(0x80 + (hi - lo) + 1)));
+      }
+      static reg fold(reg v) noexcept { return _mm_or_si128(v, splat(0x20)); }
+      static uint32_t mask(reg v) noexcept { return static_cast<uint32_t>(_mm_movemask_epi8(v)); }
+    };
+
+    // Vector loop over whole blocks; `stops(ops, v)` yields a bitmask of the
+    // bytes that end the run. Returns the stop, or null with `p` left at the
+    // start of the scalar tail. AVX2 builds still take a 16-byte step before
+    // the tail, since most lexer runs are shorter than 32 bytes.
+    template <class Stops>
+    inline const char* block_find(const char*& p, const char* end, Stops stops) noexcept {
+#if defined(TRIAD_SCAN_AVX2)
+      while (static_cast<size_t>(end - p) >= V256::width) {
+        uint32_t m = stops(V256{}, V256::load(p));
+        if (m) return p + ctz(m);
+        p += V256::width;
+      }
+#endif
+      while (static_cast<size_t>(end - p) >= V128::width) {
+        uint32_t m = stops(V128{}, V128::load(p));
+        if (m) return p + ctz(m);
+        p += V128::width;
+      }
+      return nullptr;
+    }
+
+    template <class O>
+    inline uint32_t ident_mask(typename O::reg v) noexcept {
+      typename O::reg letter = O::range(O::fold(v), 'a', 'z');
+      typename O::reg digit = O::range(v, '0', '9');
+      return O::mask(O::either(O::either(letter, digit), O::eq(v, '_')));
+    }
+#endif
+
+  } // namespace detail
+
+  // Skip ' ', '\t', '\n', '\v', '\f', '\r'.
+  inline const char* skip_space(const char* p, const char* end) noexcept {
+#if defined(TRIAD_SCAN_SSE2)
+    if (const char* q = detail::block_find(p, end, [](auto o, auto v) {
+          using O = decltype(o);
+          return ~O::mask(O::either(O::eq(v, ' '), O::range(v, '\t', '\r'))) & O::full;
+        })) return q;
+#endif
+    while (p < end && detail::is_space(*p)) ++p;
+    return p;
+  }
+
+  // Skip ' ' and '\t' only; line breaks are significant to the caller.
+  inline const char* skip_blanks(const char* p, const char* end) noexcept {
+#if defined(TRIAD_SCAN_SSE2)
+    if (const char* q = detail::block_find(p, end, [](auto o, auto v) {
+          using O = decltype(o);
+          return ~O::mask(O::either(O::eq(v, ' '), O::eq(v, '\t'))) & O::full;
+        })) return q;
+#endif
+    while (p < end && detail::is_blank(*p)) ++p;
+    return p;
+  }
+
+  // Skip [A-Za-z0-9_].
+  inline const char* skip_ident(const char* p, const char* end) noexcept {
+#if defined(TRIAD_SCAN_SSE2)
+    if (const char* q = detail::block_find(p, end, [](auto o, auto v) {
+          using O = decltype(o);
+          return ~detail::ident_mask<O>(v) & O::full;
+        })) return q;
+#endif
+    while (p < end && detail::is_ident(*p)) ++p;
+    return p;
+  }
+
+  // First occurrence of `a`.
+  inline const char* find(const char* p, const char* end, char a) noexcept {
+#if defined(TRIAD_SCAN_SSE2)
+    if (const char* q = detail::block_find(p, end, [a](auto o, auto v) {
+          using O = decltype(o);
+          return O::mask(O::eq(v, a));
+        })) return q;
+#endif
+    while (p < end && *p != a) ++p;
+    return p;
+  }
+
+  // First occurrence of `a` or `b` (line ends: '\n', '\r'; block comments: '*', '/').
+  inline const char* find_either(const char* p, const char* end, char a, char b) noexcept {
+#if defined(TRIAD_SCAN_SSE2)
+    if (const char* q = detail::block_find(p, end, [a, b](auto o, auto v) {
+          using O = decltype(o);
+          return O::mask(O::either(O::eq(v, a), O::eq(v, b)));
+        })) return q;
+#endif
+    while (p < end && *p != a && *p != b) ++p;
+    return p;
+  }
+
+  // First occurrence of any of four bytes (string bodies: '"', '\\', '\n', '\r').
+  inline const char* find_any(const char* p, const char* end, char a, char b, char c, char d) noexcept {
+#if defined(TRIAD_SCAN_SSE2)
+    if (const char* q = detail::block_find(p, end, [a, b, c, d](auto o, auto v) {
+          using O = decltype(o);
+          return O::mask(O::either(O::either(O::eq(v, a), O::eq(v, b)), O::either(O::eq(v, c), O::eq(v, d))));
+        })) return q;
+#endif
+    while (p < end && *p != a && *p != b && *p != c && *p != d) ++p;
+    return p;
+  }
+
+  // Number of '\n' in [p, end); `last` receives the final one (untouched if none).
+  // Lets the lexer jump over a run and fix up line/column in one step.
+  inline size_t count_newlines(const char* p, const char* end, const char** last) noexcept {
+    size_t n = 0;
+#if defined(TRIAD_SCAN_SSE2)
+    using detail::V128;
+    while (static_cast<size_t>(end - p) >= V128::width) {
+      uint32_t m = V128::mask(V128::eq(V128::load(p), '\n'));
+      if (m) {
+        n += detail::popcount(m);
+        *last = p + (31u - detail::clz(m));
+      }
+      p += V128::width;
+    }
+#endif
+    for (; p < end; ++p) {
+      if (*p == '\n') { ++n; *last = p; }
+    }
+    return n;
+  }
+
+} // namespace scan
+} // namespace triad
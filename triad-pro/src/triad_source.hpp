@@ -0,0 +1,133 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace triad {
+
+  // Read-only source text for one compilation. Regular files are mmap'ed so
+  // tokens can refer to (offset, length) windows without copying anything;
+  // pipes, FIFOs and devices (/dev/stdin) are read into one buffer in large
+  // reads. The lexer, diagnostics and the line table all take views of the
+  // same bytes; the buffer must outlive every token and view taken from it.
+  class SourceBuffer {
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::string owned_;
+    std::string path_;
+
+  public:
+    SourceBuffer() noexcept = default;
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+    SourceBuffer(SourceBuffer&& o) noexcept { *this = std::move(o); }
+
+    SourceBuffer& operator=(SourceBuffer&& o) noexcept {
+      if (this == &o) return *this;
+      release();
+      mapped_ = o.mapped_;
+      owned_ = std::move(o.owned_);
+      path_ = std::move(o.path_);
+      data_ = mapped_ ? o.data_ : owned_.data();
+      size_ = o.size_;
+      o.data_ = nullptr; o.size_ = 0; o.mapped_ = false;
+      return *this;
+    }
+
+    ~SourceBuffer() { release(); }
+
+    [[nodiscard]] static SourceBuffer from_string(std::string text, std::string name = "<memory>") {
+      SourceBuffer b;
+      b.owned_ = std::move(text);
+      b.data_ = b.owned_.data();
+      b.size_ = b.owned_.size();
+      b.path_ = std::move(name);
+      return b;
+    }
+
+    [[nodiscard]] static SourceBuffer open(const std::string& path) {
+      SourceBuffer b;
+      b.path_ = path;
+#if defined(_WIN32)
+      std::ifstream f(path, std::ios::binary | std::ios::ate);
+      if (!f) throw std::runtime_error("Cannot open file: " + path);
+      b.owned_.resize(static_cast<size_t>(f.tellg()));
+      f.seekg(0);
+      if (!f.read(b.owned_.data(), static_cast<std::streamsize>(b.owned_.size())))
+        throw std::runtime_error("Cannot read file: " + path);
+      b.data_ = b.owned_.data();
+      b.size_ = b.owned_.size();
+#else
+      int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0) throw std::runtime_error("Cannot open file: " + path);
+      struct stat st {};
+      if (::fstat(fd, &st) != 0 || S_ISDIR(st.st_mode)) {
+        ::close(fd);
+        throw std::runtime_error("Not a file: " + path);
+      }
+      if (S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+          ::madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL); // the lexer reads it front to back
+          b.data_ = static_cast<const char*>(p);
+          b.size_ = static_cast<size_t>(st.st_size);
+          b.mapped_ = true;
+        }
+      }
+      // Not mapped (a pipe, an empty or /proc file, a file system without
+      // mmap): read it, in one read when the size is known.
+      const bool ok = b.mapped_ || b.read_all(fd, S_ISREG(st.st_mode) ? size_t(st.st_size) : 0);
+      ::close(fd);
+      if (!ok) throw std::runtime_error("Cannot read file: " + path);
+#endif
+      return b;
+    }
+
+    [[nodiscard]] std::string_view view() const noexcept { return {data_ ? data_ : "", size_}; }
+    [[nodiscard]] const char* data() const noexcept { return data_; }
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+    [[nodiscard]] const std::string& path() const noexcept { return path_; }
+
+  private:
+#if !defined(_WIN32)
+    // Everything up to end of file into owned_; `hint`: the expected size.
+    bool read_all(int fd, size_t hint) {
+      size_t used = 0;
+      owned_.resize(hint ? hint + 1 : size_t(1) << 16); // + 1: end of file without growing
+      for (;;) {
+        if (used == owned_.size()) owned_.resize(owned_.size() * 2);
+        const ssize_t n = ::read(fd, owned_.data() + used, owned_.size() - used);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return false;
+        if (n == 0) break;
+        used += static_cast<size_t>(n);
+      }
+      owned_.resize(used);
+      data_ = owned_.data();
+      size_ = used;
+      return true;
+    }
+#endif
+
+    void release() noexcept {
+#if !defined(_WIN32)
+      if (mapped_ && data_) ::munmap(const_cast<char*>(data_), size_);
+#endif
+      data_ = nullptr; size_ = 0; mapped_ = false;
+    }
+  };
+
+} // namespace triad
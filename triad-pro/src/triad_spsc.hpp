@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+
+namespace triad {
+
+  // Bounded lock-free queue between exactly one producer thread and one
+  // consumer thread. Each side owns one index and only reads the other's, so
+  // a push or pop is a plain store plus one release. push()/pop() spin
+  // (yielding) while the queue is full/empty: the stages it connects are
+  // expected to keep each other busy.
+  template <class T, size_t N>
+  class SpscQueue {
+    static_assert(N && (N & (N - 1)) == 0, "capacity must be a power of two");
+    static constexpr size_t kLine = 64;
+
+    alignas(kLine) std::atomic<size_t> head_{0}; // next slot to pop; written by the consumer
+    alignas(kLine) std::atomic<size_t> tail_{0}; // next slot to push; written by the producer
+    alignas(kLine) T slots_[N];
+
+  public:
+    SpscQueue() = default;
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    bool try_push(T& v) {
+      const size_t t = tail_.load(std::memory_order_relaxed);
+      if (t - head_.load(std::memory_order_acquire) == N) return false;
+      slots_[t & (N - 1)] = std::move(v);
+      tail_.store(t + 1, std::memory_order_release);
+      return true;
+    }
+
+    bool try_pop(T& out) {
+      const size_t h = head_.load(std::memory_order_relaxed);
+      if (h == tail_.load(std::memory_order_acquire)) return false;
+      out = std::move(slots_[h & (N - 1)]);
+      head_.store(h + 1, std::memory_order_release);
+      return true;
+    }
+
+    void push(T v) {
+      while (!try_push(v)) std::this_thread::yield();
+    }
+
+    T pop() {
+      T v{};
+      while (!try_pop(v)) std::this_thread::yield();
+      return v;
+    }
+  };
+
+} // namespace triad
@@ -0,0 +1,165 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace triad {
+
+  namespace timeline_detail {
+
+    inline std::string json_string(std::string_view s) {
+      std::string out = "\"";
+      for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof buf, "\\u%04x", c);
+          out += buf;
+          continue;
+        }
+        out += c;
+      }
+      return out + "\"";
+    }
+
+  } // namespace timeline_detail
+
+  // triadc --timeline. Spans with begin and end times (compile phases,
+  // pipeline tasks, capsule runs) written as Chrome Trace Event JSON for
+  // Perfetto or about:tracing. Each thread appends to a buffer of its own, so
+  // only a thread's first span takes the lock; spans shorter than `minMicros`
+  // are dropped. Spans are recorded while the timeline is started (one at a
+  // time per process) and written once the threads that recorded them are done.
+  class Timeline {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    explicit Timeline(uint64_t minMicros = 0)
+      : min_(std::chrono::microseconds(minMicros)), origin_(clock::now()), gen_(++generations_) {}
+    ~Timeline() { stop(); }
+
+    Timeline(const Timeline&) = delete;
+    Timeline& operator=(const Timeline&) = delete;
+
+    void start() noexcept { active_.store(this, std::memory_order_release); }
+    void stop() noexcept {
+      Timeline* self = this;
+      active_.compare_exchange_strong(self, nullptr);
+    }
+    [[nodiscard]] static Timeline* active() noexcept { return active_.load(std::memory_order_acquire); }
+
+    // How the calling thread is labelled in the viewer ("lexer", "compile 2").
+    void name_thread(std::string name) { local().name = std::move(name); }
+
+    void add(const char* cat, const char* name, std::string detail, clock::time_point begin, clock::time_point end) {
+      if (end - begin < min_) return;
+      local().events.push_back({cat, name, std::move(detail), begin - origin_, end - begin});
+    }
+
+    [[nodiscard]] size_t size() const {
+      std::lock_guard<std::mutex> lock(mu_);
+      size_t n = 0;
+      for (const auto& b : buffers_) n += b->events.size();
+      return n;
+    }
+
+    // {"traceEvents": [...]}: thread names, then one complete ("X") event
+    // per span, timestamps in microseconds from the timeline's creation.
+    void write(std::ostream& os) const {
+      using timeline_detail::json_string;
+      std::lock_guard<std::mutex> lock(mu_);
+      const auto us = [](clock::duration d) {
+        char buf[32];
+        std::snprintf(buf, sizeof buf, "%.3f", std::chrono::duration<double, std::micro>(d).count());
+        return std::string(buf);
+      };
+      os << "{\"traceEvents\": [\n"
+         << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"triadc\"}}";
+      for (const auto& b : buffers_)
+        if (!b->name.empty())
+          os << ",\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << b->tid
+             << ", \"args\": {\"name\": " << json_string(b->name) << "}}";
+      for (const auto& b : buffers_)
+        for (const Event& e : b->events) {
+          os << ",\n  {\"name\": " << json_string(e.name) << ", \"cat\": " << json_string(e.cat)
+             << ", \"ph\": \"X\", \"ts\": " << us(e.begin) << ", \"dur\": " << us(e.dur)
+             << ", \"pid\": 1, \"tid\": " << b->tid;
+          if (!e.detail.empty()) os << ", \"args\": {\"detail\": " << json_string(e.detail) << "}";
+          os << "}";
+        }
+      os << "\n], \"displayTimeUnit\": \"ms\"}\n";
+    }
+
+  private:
+    struct Event {
+      const char* cat;
+      const char* name;
+      std::string detail;
+      clock::duration begin; // from origin_
+      clock::duration dur;
+    };
+    struct Buffer {
+      int tid;
+      std::string name;
+      std::vector<Event> events;
+    };
+
+    const clock::duration min_;
+    const clock::time_point origin_;
+    const uint64_t gen_; // tells this timeline's thread buffers from an earlier one's at the same address
+    mutable std::mutex mu_;
+    std::vector<std::unique_ptr<Buffer>> buffers_;
+
+    static inline std::atomic<Timeline*> active_{nullptr};
+    static inline std::atomic<uint64_t> generations_{0};
+
+    Buffer& local() {
+      thread_local uint64_t gen = 0;
+      thread_local Buffer* buf = nullptr;
+      if (gen != gen_) {
+        std::lock_guard<std::mutex> lock(mu_);
+        buffers_.push_back(std::make_unique<Buffer>());
+        buffers_.back()->tid = static_cast<int>(buffers_.size());
+        buf = buffers_.back().get();
+        gen = gen_;
+      }
+      return *buf;
+    }
+  };
+
+  // A span on the active timeline from construction to destruction. With no
+  // timeline started it is one atomic load; `cat` and `name` must outlive the
+  // timeline (string literals).
+  class TimelineSpan {
+  public:
+    TimelineSpan(const char* cat, const char* name) noexcept : tl_(Timeline::active()), cat_(cat), name_(name) {
+      if (tl_) begin_ = Timeline::clock::now();
+    }
+    ~TimelineSpan() {
+      if (tl_) tl_->add(cat_, name_, std::move(detail_), begin_, Timeline::clock::now());
+    }
+
+    TimelineSpan(const TimelineSpan&) = delete;
+    TimelineSpan& operator=(const TimelineSpan&) = delete;
+
+    [[nodiscard]] bool recording() const noexcept { return tl_ != nullptr; }
+    // Shown under the span's arguments; build it only when recording().
+    void detail(std::string text) { detail_ = std::move(text); }
+
+  private:
+    Timeline* tl_;
+    const char* cat_;
+    const char* name_;
+    Timeline::clock::time_point begin_{};
+    std::string detail_;
+  };
+
+} // namespace triad
@@ -0,0 +1,133 @@
+#pragma once
+#include "triad_lexer.hpp"
+#include <algorithm>
+#include <istream>
+#include <string>
+#include <string_view>
+
+namespace triad {
+
+  // Pull-based token source for the parser: tokens are lexed on demand into a
+  // small ring, so lexing and parsing run as one pass in constant token memory.
+  //
+  // Over an in-memory buffer the lexer simply walks the whole view. Over an
+  // std::istream the text is read in chunks into a sliding window; bytes are
+  // dropped once no buffered token refers to them, and a token that reaches
+  // the end of the window is lexed again after the next chunk arrives, so a
+  // chunk boundary can never split an identifier, string or comment.
+  //
+  // A stream can also replay tokens lexed earlier (a range of a list ending
+  // in Eof), so that part of a document can be parsed again without lexing.
+  //
+  // Token text (text()) stays valid while the token is in the lookahead ring
+  // or is the one advance() last returned; copy it before pulling further.
+  class TokenStream {
+    static constexpr size_t kRing = 8;          // power of two; max lookahead
+    static constexpr size_t kChunk = 64 * 1024; // default istream read size
+    static constexpr size_t kSlack = 2;         // bytes the lexer may peek past a token
+
+    Lexer lx_;
+    std::string_view src_;       // in-memory input
+    std::istream* in_ = nullptr; // streamed input, windowed in buf_
+    std::string buf_;            // bytes [base_, base_ + buf_.size()) of the stream
+    size_t base_ = 0;
+    size_t chunk_ = kChunk;
+    bool eof_ = true;
+    const Token* replay_ = nullptr; // replayed tokens, up to and including Eof
+    const Token* replayEnd_ = nullptr;
+
+    Token ring_[kRing];
+    size_t head_ = 0; // tokens handed out
+    size_t tail_ = 0; // tokens lexed
+    Token prev_;
+
+  public:
+    explicit TokenStream(std::string_view src) : lx_(src), src_(src) {}
+
+    // `chunk` is the read size; tests make it small to put chunk boundaries
+    // inside tokens.
+    explicit TokenStream(std::istream& in, size_t chunk = kChunk)
+      : lx_(std::string_view{}), in_(&in), chunk_(std::max<size_t>(chunk, 1)), eof_(false) {
+      refill(0);
+    }
+
+    // Replay [first, last) of tokens lexed from `src`; *(last - 1) is Eof.
+    TokenStream(std::string_view src, const Token* first, const Token* last)
+      : lx_(src), src_(src), replay_(first), replayEnd_(last) {}
+
+    TokenStream(const TokenStream&) = delete;
+    TokenStream& operator=(const TokenStream&) = delete;
+
+    // k-th token ahead without consuming it (k < kRing).
+    [[nodiscard]] const Token& peek(size_t k = 0) {
+      while (tail_ - head_ <= k) pull();
+      return ring_[(head_ + k) & (kRing - 1)];
+    }
+
+    // Consume and return the next token; at Eof the stream stays at Eof.
+    const Token& advance() {
+      prev_ = peek();
+      if (prev_.kind != TokKind::Eof) ++head_;
+      return prev_;
+    }
+
+    [[nodiscard]] const Token& prev() const noexcept { return prev_; }
+
+    // Tokens consumed so far.
+    [[nodiscard]] size_t consumed() const noexcept { return head_; }
+
+    // Line and column of a token still buffered (or prev()), for diagnostics.
+    [[nodiscard]] LineCol where(const Token& tok) const noexcept {
+      return lx_.where(in_ ? tok.off - base_ : tok.off);
+    }
+
+    [[nodiscard]] std::string_view text(const Token& tok) const noexcept {
+      if (!in_) return tok.text(src_);
+      return std::string_view(buf_).substr(tok.off - base_, tok.len);
+    }
+
+  private:
+    void pull() {
+      if (replay_) {
+        ring_[tail_++ & (kRing - 1)] = *replay_;
+        if (replay_ + 1 < replayEnd_) ++replay_;
+        return;
+      }
+      for (;;) {
+        Lexer::Mark m = lx_.mark();
+        Token tok = lx_.next();
+        if (!eof_ && lx_.position() + kSlack > buf_.size()) {
+          // The token (or the whitespace before Eof) may continue in the
+          // next chunk: rewind, read more, and lex it again.
+          lx_.reset(m);
+          refill(m.index);
+          continue;
+        }
+        tok.off += static_cast<uint32_t>(base_); // refill keeps base_ + window within kMaxSourceBytes
+        ring_[tail_++ & (kRing - 1)] = tok;
+        return;
+      }
+    }
+
+    // Drop bytes no live token needs, then append the next chunk. `resume`
+    // is where the lexer restarts, relative to the current window.
+    void refill(size_t resume) {
+      size_t keep = base_ + resume;
+      for (size_t n = head_; n < tail_; ++n) keep = std::min<size_t>(keep, ring_[n & (kRing - 1)].off);
+      if (head_ > 0) keep = std::min<size_t>(keep, prev_.off);
+      const size_t dropped = keep - base_;
+      const LineCol origin = lx_.where(dropped);
+      buf_.erase(0, dropped);
+      base_ = keep;
+
+      const size_t have = buf_.size();
+      buf_.resize(have + chunk_);
+      in_->read(&buf_[have], static_cast<std::streamsize>(chunk_));
+      buf_.resize(have + static_cast<size_t>(in_->gcount()));
+      Lexer::check_size(base_ + buf_.size()); // whole-stream offsets must fit a Token
+      if (!*in_) eof_ = true;
+      lx_.rebase(buf_, dropped, origin, !eof_);
+    }
+  };
+
+} // namespace triad
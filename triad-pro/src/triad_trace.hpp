@@ -0,0 +1,168 @@
+#pragma once
+#include "triad_bytecode.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace triad {
+
+  // One traced instruction: 8 bytes, no text.
+  struct TraceRecord {
+    uint32_t ip;
+    uint16_t depth;  // operand stack depth before it ran, saturating
+    uint8_t op;
+    uint8_t frames;  // call frames, saturating
+  };
+  static_assert(sizeof(TraceRecord) == 8, "trace records are 8 bytes");
+
+  // Start of a trace file; `capacity` records follow it.
+  struct TraceHeader {
+    static constexpr uint32_t kVersion = 1;
+    enum : uint32_t { kRunning = 0, kFinished = 1, kFailed = 2 };
+
+    char magic[8];         // "TRIADTRC"
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t capacity;     // a power of two
+    uint64_t written;      // records ever written; the newest is (written - 1) % capacity
+    uint64_t every;        // one record per `every` instructions
+    uint64_t fingerprint;  // code_fingerprint of the traced chunk
+    uint32_t codeSize;
+    uint32_t status;       // kRunning after a crash
+    char source[256];      // program path, for trace-dump
+  };
+
+  // triadc --trace-vm. The VM appends a record per instruction (or per
+  // `every` instructions) to a ring in a shared file mapping, so writing one
+  // is two stores and the last `capacity` records survive the process: a
+  // crash leaves them in the page cache for `triadc trace-dump`.
+  class TraceRing {
+    TraceHeader* hdr_ = nullptr;
+    TraceRecord* recs_ = nullptr;
+    size_t bytes_ = 0;
+    uint64_t mask_ = 0;
+    uint64_t written_ = 0;
+    uint64_t every_ = 1;
+    uint64_t countdown_ = 1;
+
+  public:
+    TraceRing() noexcept = default;
+    TraceRing(const TraceRing&) = delete;
+    TraceRing& operator=(const TraceRing&) = delete;
+    TraceRing(TraceRing&& o) noexcept { *this = std::move(o); }
+    TraceRing& operator=(TraceRing&& o) noexcept {
+      if (this == &o) return *this;
+      release();
+      std::swap(hdr_, o.hdr_);
+      std::swap(recs_, o.recs_);
+      std::swap(bytes_, o.bytes_);
+      mask_ = o.mask_;
+      written_ = o.written_;
+      every_ = o.every_;
+      countdown_ = o.countdown_;
+      return *this;
+    }
+    ~TraceRing() { release(); }
+
+    // Create (or truncate) `path` with room for `capacity` records, rounded
+    // up to a power of two.
+    [[nodiscard]] static TraceRing create(const std::string& path, uint64_t capacity, uint64_t every, const Chunk& ch,
+                                          const std::string& source) {
+      TraceRing r;
+#if defined(_WIN32)
+      (void)path; (void)capacity; (void)every; (void)ch; (void)source;
+      throw std::runtime_error("--trace-vm needs a shared file mapping (POSIX)");
+#else
+      uint64_t cap = 1;
+      while (cap < std::max<uint64_t>(capacity, 16)) cap <<= 1;
+      r.bytes_ = sizeof(TraceHeader) + cap * sizeof(TraceRecord);
+      const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+      if (fd < 0) throw std::runtime_error("Cannot write to: " + path);
+      if (::ftruncate(fd, static_cast<off_t>(r.bytes_)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot size trace file: " + path);
+      }
+      void* p = ::mmap(nullptr, r.bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      ::close(fd);
+      if (p == MAP_FAILED) throw std::runtime_error("Cannot map file: " + path);
+      r.hdr_ = static_cast<TraceHeader*>(p);
+      r.recs_ = reinterpret_cast<TraceRecord*>(r.hdr_ + 1);
+      std::memcpy(r.hdr_->magic, "TRIADTRC", 8);
+      r.hdr_->version = TraceHeader::kVersion;
+      r.hdr_->recordSize = sizeof(TraceRecord);
+      r.hdr_->capacity = cap;
+      r.hdr_->written = 0;
+      r.hdr_->every = std::max<uint64_t>(every, 1);
+      r.hdr_->fingerprint = code_fingerprint(ch);
+      r.hdr_->codeSize = static_cast<uint32_t>(ch.code.size());
+      r.hdr_->status = TraceHeader::kRunning;
+      std::strncpy(r.hdr_->source, source.c_str(), sizeof r.hdr_->source - 1);
+      r.mask_ = cap - 1;
+      r.every_ = r.hdr_->every;
+      return r;
+#endif
+    }
+
+    void record(size_t ip, Op op, size_t depth, size_t frames) noexcept {
+      if (--countdown_) return;
+      countdown_ = every_;
+      recs_[written_ & mask_] = {static_cast<uint32_t>(ip), static_cast<uint16_t>(std::min<size_t>(depth, 0xffff)),
+                                 static_cast<uint8_t>(op), static_cast<uint8_t>(std::min<size_t>(frames, 0xff))};
+      hdr_->written = ++written_;
+    }
+
+    // How the run ended; a trace left kRunning was cut short.
+    void finish(bool ok) noexcept {
+      if (hdr_) hdr_->status = ok ? TraceHeader::kFinished : TraceHeader::kFailed;
+    }
+
+  private:
+    void release() noexcept {
+#if !defined(_WIN32)
+      if (hdr_) ::munmap(hdr_, bytes_);
+#endif
+      hdr_ = nullptr;
+      recs_ = nullptr;
+    }
+  };
+
+  // A trace file read back for decoding, oldest record first.
+  struct TraceDump {
+    TraceHeader header{};
+    uint64_t first = 0;               // sequence number of records[0]
+    std::vector<TraceRecord> records;
+
+    [[nodiscard]] static TraceDump read(const std::string& path) {
+      std::ifstream f(path, std::ios::binary);
+      if (!f) throw std::runtime_error("Cannot open file: " + path);
+      TraceDump d;
+      if (!f.read(reinterpret_cast<char*>(&d.header), sizeof d.header) || std::memcmp(d.header.magic, "TRIADTRC", 8) != 0)
+        throw std::runtime_error("Not a triad trace: " + path);
+      const TraceHeader& h = d.header;
+      if (h.version != TraceHeader::kVersion || h.recordSize != sizeof(TraceRecord))
+        throw std::runtime_error("Trace version " + std::to_string(h.version) + " is not supported");
+      if (h.capacity == 0 || (h.capacity & (h.capacity - 1)) != 0) throw std::runtime_error("Corrupt trace header: " + path);
+      std::vector<TraceRecord> ring(h.capacity);
+      if (!f.read(reinterpret_cast<char*>(ring.data()), static_cast<std::streamsize>(h.capacity * sizeof(TraceRecord))))
+        throw std::runtime_error("Truncated trace: " + path);
+      const uint64_t kept = std::min(h.written, h.capacity);
+      d.first = h.written - kept;
+      d.records.reserve(kept);
+      for (uint64_t n = d.first; n < h.written; ++n) d.records.push_back(ring[n & (h.capacity - 1)]);
+      return d;
+    }
+  };
+
+} // namespace triad
@@ -1,23 +1,62 @@
 #include "triad_parser.cpp"
 #include "triad_vm.cpp"
 #include "triad_ast.hpp"
+#include "triad_source.hpp"
+#include "triad_profile.hpp"
+#include "triad_pgo.hpp"
+#include "triad_trace.hpp"
+#include "triad_timeline.hpp"
+#include "triad_perf.hpp"
+#include "triad_alloc.hpp"
+#include "triad_phases.hpp"
+#include "triad_ngrams.hpp"
+#include "triad_output.hpp"
+#include "triad_batch.hpp"
+#include "triad_lines.hpp"
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <iomanip>
 #include <sstream>
 #include <iostream>
+#include <streambuf>
 #include <filesystem>
 #include <string_view>
 #include <variant>
 #include <optional>
+#include <chrono>
+#include <new>
+#include <thread>
+#include <mutex>
 
 namespace fs = std::filesystem;
 using std::string_view;
 using namespace triad;
 
-[[nodiscard]] static std::string slurp(const std::string& path) noexcept {
-  std::ifstream f(path);
-  if (!f) throw std::runtime_error("Cannot open file: " + path);
-  return std::string((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+static constexpr const char* kTriadcVersion = "0.9.1";
+
+// Every allocation passes AllocProfiler (--profile=alloc) and AllocCounter
+// (--time-phases), which return at once unless they are recording. The array, nothrow and sized
+// forms forward here by default.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // malloc/free behind new/delete is the point
+#endif
+void* operator new(std::size_t n) {
+  void* p = std::malloc(n ? n : 1);
+  if (!p) throw std::bad_alloc();
+  AllocProfiler::on_alloc(p, n);
+  AllocCounter::on_alloc(n);
+  return p;
+}
+void operator delete(void* p) noexcept {
+  AllocProfiler::on_free(p);
+  std::free(p);
 }
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
 
 static void emit_to_file(const std::string& code, const std::string& outPath) {
   std::ofstream out(outPath);
@@ -25,44 +64,444 @@ static void emit_to_file(const std::string& code, const std::string& outPath) {
   out << code;
 }
 
-static void run_vm(const Chunk& ch, bool trace = false) {
+// --bytecode: one line per instruction, disassembled as the profilers print it.
+static void dump_chunk(const Chunk& ch) {
+  for (size_t ip = 0; ip < ch.code.size(); ++ip)
+    std::cout << std::setw(5) << ip << "  " << profile_detail::disasm(ch, ch.code[ip]) << "\n";
+}
+
+// No native back end yet; the modes are reserved.
+static std::string emit_nasm(const Chunk&) { throw std::runtime_error("emit-nasm is not implemented"); }
+static std::string emit_llvm(const Chunk&) { throw std::runtime_error("emit-llvm is not implemented"); }
+
+// --trace-vm: where the binary instruction trace goes and how much it keeps.
+struct TraceOptions {
+  std::string file;                      // empty: not tracing
+  uint64_t every = 1;                    // one record per `every` instructions
+  uint64_t records = uint64_t(1) << 20;  // ring size (8 MiB)
+};
+
+// The capsule a file runs as, for profiles and the --timeline.
+static std::string capsule_name(const std::string& path) {
+  return fs::path(path == "-" ? "stdin" : path).stem().string();
+}
+
+// Execute with the --trace-vm ring attached, if any. The ring is marked
+// finished or failed on the way out; one left running was cut short.
+static void exec_traced(VM& vm, const Chunk& ch, const TraceOptions& trace, const std::string& path) {
+  TimelineSpan span("vm", "run capsule");
+  if (span.recording()) span.detail(capsule_name(path));
+  if (trace.file.empty()) return vm.exec(ch);
+  std::error_code ec;
+  const fs::path abs = path == "-" ? fs::path() : fs::absolute(path, ec);
+  TraceRing ring = TraceRing::create(trace.file, trace.records, trace.every, ch, abs.string());
+  vm.trace_into(ring);
+  try {
+    vm.exec(ch);
+  } catch (...) {
+    ring.finish(false);
+    throw;
+  }
+  ring.finish(true);
+}
+
+static void run_vm(const Chunk& ch, const TraceOptions& trace = {}, const std::string& path = "-") {
+  VM vm;
+  exec_traced(vm, ch, trace, path);
+}
+
+// --profile=sample: run under SampleProfiler and write folded stacks, one
+// per hot source line, next to the source for flamegraph.pl.
+static void profile_vm(const Chunk& ch, std::string_view src, const std::string& path) {
+  SampleProfiler prof(ch);
+  VM vm;
+  vm.publish_ip(prof.ip);
+  prof.start();
+  try {
+    TimelineSpan span("vm", "run capsule");
+    if (span.recording()) span.detail(capsule_name(path));
+    vm.exec(ch);
+  } catch (...) {
+    prof.stop();
+    throw;
+  }
+  prof.stop();
+
+  const std::string out = (path == "-" ? std::string("stdin") : path) + ".folded";
+  std::ofstream f(out);
+  if (!f) throw std::runtime_error("Cannot write to: " + out);
+  prof.write_folded(f, src, capsule_name(path));
+  std::cerr << "[profile] " << prof.samples() << " samples (" << prof.outside() << " outside the VM) -> " << out
+            << "   flamegraph.pl " << out << " > profile.svg\n";
+}
+
+// --profile=alloc: charge heap allocations to the instruction that made them
+// and report the heaviest sites and what is still live at the end, on stderr.
+static void alloc_vm(const Chunk& ch, std::string_view src) {
+  AllocProfiler prof(ch);
+  VM vm;
+  vm.publish_ip(prof.ip);
+  prof.start();
+  try {
+    vm.exec(ch);
+  } catch (...) {
+    prof.stop();
+    throw;
+  }
+  prof.stop();
+  prof.write_report(std::cerr, src);
+}
+
+// --hw-counters: read the CPU's counters around the run and report them per
+// bytecode instruction executed, on stderr. Without counters (no PMU, a
+// container, perf_event_paranoid) the program still runs and says why.
+static void hw_vm(const Chunk& ch, const TraceOptions& trace, const std::string& path) {
+  HwCounters hw;
+  if (!hw.any()) std::cerr << "[hw] hardware counters unavailable (" << hw.reason() << "); running without them\n";
+  uint64_t executed = 0;
+  VM vm;
+  vm.tally_into(executed);
+  hw.start();
+  try {
+    exec_traced(vm, ch, trace, path);
+  } catch (...) {
+    (void)hw.stop();
+    throw;
+  }
+  const HwReading r = hw.stop();
+  if (hw.any()) write_hw_report(std::cerr, r, executed);
+}
+
+// --profile: run with exact per-instruction counts and print the hottest
+// instructions and the opcode mix to stderr (program output stays on stdout).
+// --profile-out: save the counts for --profile-use, added to those already
+// in the file if it was recorded for the same code.
+static void count_vm(const Chunk& ch, std::string_view src, const TraceOptions& trace, const std::string& path, bool report,
+                     const std::string& profileOut) {
+  ProfileData counts;
   VM vm;
-  if (trace) vm.enable_trace(); // capsule-aware trace hook
-  vm.exec(ch);
+  vm.count_into(counts);
+  exec_traced(vm, ch, trace, path);
+  if (report) write_report(std::cerr, counts, ch, src);
+  if (profileOut.empty()) return;
+
+  PgoProfile prof = make_profile(ch, counts);
+  if (std::ifstream old{profileOut}) {
+    PgoProfile before = read_profile(old);
+    if (before.fingerprint == prof.fingerprint) merge_profile(prof, before);
+  }
+  std::ofstream f(profileOut);
+  if (!f) throw std::runtime_error("Cannot write to: " + profileOut);
+  write_profile(f, prof);
+  std::cerr << "[pgo] " << prof.runs << " run(s) recorded in " << profileOut << "\n";
+}
+
+// --profile-use: lay out `ch` from a training run's profile. A profile of
+// other code (the program changed since) is ignored with a warning.
+static void use_profile(Chunk& ch, const std::string& path, bool verbose) {
+  TimelineSpan span("compile", "pgo layout");
+  std::ifstream f(path);
+  if (!f) throw std::runtime_error("Cannot open file: " + path);
+  const PgoProfile prof = read_profile(f);
+  if (prof.fingerprint != code_fingerprint(ch) || prof.codeSize != ch.code.size()) {
+    std::cerr << "[pgo] " << path << " was recorded for different code; ignoring it\n";
+    return;
+  }
+  const PgoStats st = apply_pgo(ch, prof);
+  if (verbose) std::cout << "[pgo: " << st.blocks << " blocks, " << st.cold << " cold moved last, "
+                         << st.jumpsRemoved << " jumps removed, " << st.jumpsAdded << " added]\n";
 }
 
-static void run_ast(const std::string& src) {
+static void run_ast(std::string_view src) {
   std::cout << "[AST interpreter not yet implemented]\n";
 }
 
-static void run_tests(bool verbose = false) {
+// --watch: keep the file compiled and rebuild it on every save. The saved
+// text is diffed against the previous one, so only the edited token window is
+// re-lexed and only the statements around it are reparsed (IncrementalParser).
+[[noreturn]] static void watch(const std::string& path, const std::string& mode, bool verbose, const TraceOptions& trace,
+                               size_t maxDepth) {
+  using clock = std::chrono::steady_clock;
+  IncrementalParser doc;
+  doc.set_max_depth(maxDepth);
+  fs::file_time_type seen{};
+  for (;;) {
+    std::error_code ec;
+    const fs::file_time_type stamp = fs::last_write_time(path, ec);
+    if (!ec && stamp != seen) {
+      seen = stamp;
+      try {
+        std::optional<TimelineSpan> span(std::in_place, "compile", "rebuild");
+        SourceBuffer file = SourceBuffer::open(path);
+        const auto t0 = clock::now();
+        const IncrementalParser::Stats st = doc.update(std::string(file.view()));
+        Chunk ch = doc.link();
+        const std::chrono::duration<double, std::milli> ms = clock::now() - t0;
+        std::cout << "[watch] " << path << ": " << ms.count() << " ms, "
+                  << st.tokensRelexed << " tokens re-lexed, " << st.unitsReparsed << "/" << st.units
+                  << " statements reparsed\n";
+        if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
+        span.reset();
+        if (mode == "run-vm") run_vm(ch, trace, path);
+        std::cout.flush();
+      } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+}
+
+static void run_tests(bool verbose = false, size_t maxDepth = kMaxNestingDepth) {
   for (const auto& entry : fs::directory_iterator("tests")) {
     if (entry.path().extension() == ".triad") {
       std::cout << "Running: " << entry.path().filename() << "\n";
-      std::string src = slurp(entry.path().string());
-      Chunk ch = parse_to_chunk(src);
-      if (verbose) std::cout << "[Parsed chunk with " << ch.code().size() << " instructions]\n";
-      run_vm(ch);
+      SourceBuffer src = SourceBuffer::open(entry.path().string());
+      Chunk ch = parse_to_chunk(src.view(), maxDepth);
+      if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
+      run_vm(ch, {}, entry.path().string());
+    }
+  }
+}
+
+// trace-dump: decode a --trace-vm file, oldest record first. The program is
+// recompiled from the path recorded in the trace (or --source) to name the
+// instructions and their lines; if it has changed since, only opcodes are shown.
+static void trace_dump(const std::string& path, std::string source, uint64_t last, size_t maxDepth) {
+  const TraceDump d = TraceDump::read(path);
+  const TraceHeader& h = d.header;
+  const char* status = h.status == TraceHeader::kFinished ? "finished"
+                     : h.status == TraceHeader::kFailed   ? "ended with an error"
+                                                          : "did not finish";
+  if (source.empty()) source.assign(h.source, strnlen(h.source, sizeof h.source));
+  std::cout << "[trace] " << path << ": " << h.written << " records, one per " << h.every << " instruction(s), last "
+            << d.records.size() << " kept; run " << status << "\n";
+
+  SourceBuffer file;
+  Chunk ch;
+  bool same = false;
+  if (!source.empty()) {
+    try {
+      file = SourceBuffer::open(source);
+      ch = parse_to_chunk(file.view(), maxDepth);
+      same = code_fingerprint(ch) == h.fingerprint && ch.code.size() == h.codeSize;
+      if (!same) std::cerr << "[trace] " << source << " has changed since it was traced; showing opcodes only\n";
+    } catch (const std::exception& e) {
+      std::cerr << "[trace] " << e.what() << "; showing opcodes only\n";
+    }
+  }
+  const std::vector<uint32_t> offs = same ? ch.lines.expand(ch.code.size()) : std::vector<uint32_t>{};
+  const std::string_view src = same ? file.view() : std::string_view{};
+  const LineIndex index(src);
+
+  const size_t from = last && last < d.records.size() ? d.records.size() - last : 0;
+  std::cout << std::setw(14) << "instruction" << std::setw(7) << "ip" << "  " << std::left << std::setw(28) << "op"
+            << std::right << std::setw(6) << "stack" << std::setw(7) << "frames" << "  source\n";
+  for (size_t i = from; i < d.records.size(); ++i) {
+    const TraceRecord& r = d.records[i];
+    const bool known = same && r.ip < ch.code.size();
+    std::cout << std::setw(14) << (d.first + i + 1) * h.every << std::setw(7) << r.ip << "  " << std::left << std::setw(28)
+              << (known ? profile_detail::disasm(ch, ch.code[r.ip]) : r.op < kOpCount ? op_name(Op(r.op)) : "?")
+              << std::right << std::setw(6) << r.depth << std::setw(7) << unsigned(r.frames) << "  "
+              << (known ? profile_detail::frame(src, index, offs[r.ip]) : "") << "\n";
+  }
+}
+
+// analyze --ngrams: opcode sequences over a corpus (a .triad file or a
+// directory searched recursively), weighted by a counted run of each program
+// unless `staticOnly`. Program output is discarded; a program that fails to
+// compile is skipped, one that fails at run time keeps the counts so far.
+static void analyze_ngrams(const std::string& path, size_t n, bool staticOnly, size_t top, size_t maxDepth) {
+  std::vector<fs::path> files;
+  if (fs::is_directory(path)) {
+    for (const auto& entry : fs::recursive_directory_iterator(path))
+      if (entry.is_regular_file() && entry.path().extension() == ".triad") files.push_back(entry.path());
+    std::sort(files.begin(), files.end());
+  } else {
+    files.push_back(path);
+  }
+  if (files.empty()) throw std::runtime_error("No .triad files in: " + path);
+
+  NgramStats stats(n);
+  for (const fs::path& file : files) {
+    Chunk ch;
+    try {
+      SourceBuffer src = SourceBuffer::open(file.string());
+      ch = parse_to_chunk(src.view(), maxDepth);
+    } catch (const std::exception& e) {
+      std::cerr << "[ngrams] skipping " << file.string() << ": " << e.what() << "\n";
+      continue;
+    }
+    if (staticOnly) {
+      stats.add(ch, nullptr);
+      continue;
+    }
+    ProfileData counts;
+    VM vm;
+    vm.count_into(counts);
+    say_stream().set_discard(true);
+    echo_stream().set_discard(true);
+    std::string failed;
+    try {
+      vm.exec(ch);
+    } catch (const std::exception& e) {
+      failed = e.what();
     }
+    say_stream().set_discard(false);
+    echo_stream().set_discard(false);
+    if (!failed.empty()) std::cerr << "[ngrams] " << file.string() << " stopped: " << failed << " (counts so far kept)\n";
+    stats.add(ch, &counts);
   }
+  stats.write_report(std::cout, top);
+}
+
+// run-batch: run the compiled program once per line of `input` ("-" for
+// stdin), with the line in the global `record`, on `jobs` threads (0: one
+// per core). Each thread keeps one VM and resets it between records; lines
+// are handed out in groups under a lock, so input is read once, in order,
+// and never held whole. Records run in any order across threads; a thread's
+// output is held back while a record runs and written out between records,
+// once --flush says so and at the end of each group, so a record's lines stay
+// together. A failing record is reported and counted, and the rest still run.
+static uint64_t run_batch(const Chunk& ch, const std::string& input, unsigned jobs) {
+  using clock = std::chrono::steady_clock;
+  static constexpr size_t kGroup = 64;    // records taken per lock
+  static constexpr uint64_t kShown = 10;  // failures reported in full
+  if (input.empty()) throw std::runtime_error("run-batch needs --input <records file | ->");
+  if (jobs == 0) jobs = std::max(1u, std::thread::hardware_concurrency());
+
+  LineReader reader = input == "-" ? LineReader::standard_input() : LineReader::open(input);
+  std::mutex lock;
+  uint64_t linesRead = 0, failures = 0;
+  std::exception_ptr readError;
+
+  // The next group of non-blank lines and the input line number of each,
+  // blank lines counted; false when the input is used up (or could not be read).
+  auto take = [&](std::vector<std::string>& group, std::vector<uint64_t>& lineNos) {
+    std::lock_guard<std::mutex> hold(lock);
+    size_t n = 0;
+    try {
+      std::string_view line;
+      while (n < kGroup && reader.next(line)) {
+        ++linesRead;
+        if (line.find_first_not_of(" \t") == std::string_view::npos) continue;
+        if (n == group.size()) group.emplace_back();
+        group[n].assign(line);
+        lineNos.resize(n + 1);
+        lineNos[n++] = linesRead;
+      }
+    } catch (...) {
+      if (!readError) readError = std::current_exception();
+    }
+    group.resize(n);
+    lineNos.resize(n);
+    return n > 0;
+  };
+
+  std::vector<BatchStats> stats(jobs);
+  auto work = [&](unsigned w) {
+    if (Timeline* tl = Timeline::active(); tl && w > 0) tl->name_thread("batch " + std::to_string(w + 1));
+    VM vm;
+    std::vector<std::string> group;
+    std::vector<uint64_t> lineNos;
+    hold_output(true);
+    while (take(group, lineNos)) {
+      for (size_t i = 0; i < group.size(); ++i) {
+        TimelineSpan span("task", "record");
+        const auto t0 = clock::now();
+        try {
+          vm.reset();
+          vm.set_global("record", group[i]);
+          vm.exec(ch, /*flush=*/false);
+        } catch (const std::exception& e) {
+          stats[w].add_failed();
+          std::lock_guard<std::mutex> hold(lock);
+          if (++failures <= kShown) std::cerr << "[batch] line " << lineNos[i] << ": " << e.what() << "\n";
+        }
+        stats[w].add(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - t0).count()));
+        stats[w].add_bytes(group[i].size() + 1);
+        flush_output_if_due();
+      }
+      flush_output();
+    }
+    hold_output(false);
+  };
+
+  const auto start = clock::now();
+  std::vector<std::thread> pool;
+  for (unsigned w = 1; w < jobs; ++w) pool.emplace_back(work, w);
+  work(0);
+  for (std::thread& t : pool) t.join();
+  const std::chrono::duration<double> wall = clock::now() - start;
+
+  if (readError) std::rethrow_exception(readError);
+  for (unsigned w = 1; w < jobs; ++w) stats[0].merge(stats[w]);
+  if (failures > kShown) std::cerr << "[batch] ... " << failures - kShown << " more failed record(s) not shown\n";
+  stats[0].write_report(std::cerr, wall.count(), jobs);
+  return stats[0].failed();
 }
 
+// --timeline: record spans from the end of option parsing until main
+// returns, then write them, whether or not the run succeeded.
+struct TimelineOutput {
+  Timeline timeline;
+  std::string path;
+
+  TimelineOutput(std::string file, uint64_t minMicros) : timeline(minMicros), path(std::move(file)) {
+    timeline.start();
+    timeline.name_thread("main");
+  }
+  ~TimelineOutput() {
+    timeline.stop();
+    std::ofstream f(path);
+    if (!f) {
+      std::cerr << "Error: Cannot write to: " << path << "\n";
+      return;
+    }
+    timeline.write(f);
+    std::cerr << "[timeline] " << timeline.size() << " spans -> " << path << "   open in ui.perfetto.dev\n";
+  }
+};
+
 int main(int argc, char** argv) {
   if (argc < 2) {
     std::cout << "Triad Compiler CLI\n"
-              << "Usage: triadc <mode> <file.triad | dir> [options]\n"
+              << "Usage: triadc <mode> <file.triad | dir | -> [options]   (- reads stdin)\n"
               << "Modes:\n"
               << "  run-vm       Execute via VM\n"
               << "  run-ast      Execute via AST interpreter\n"
               << "  emit-nasm    Emit NASM assembly\n"
               << "  emit-llvm    Emit LLVM IR\n"
+              << "  analyze      Opcode n-grams over a corpus: triadc analyze <file | dir> --ngrams <n> [--static] [--top <k>]\n"
+              << "  run-batch    Compile once, run once per input line: triadc run-batch <file.triad> --input <records | -> [--jobs <n>]\n"
+              << "  trace-dump   Decode a --trace-vm file: triadc trace-dump <file.trace> [--source <file>] [--last <n>]\n"
               << "  run-tests    Execute all .triad files in /tests\n"
               << "Options:\n"
               << "  -o <file>    Output to file\n"
               << "  --verbose    Show debug info\n"
               << "  --show-ast   Print AST\n"
               << "  --show-bytecode Print bytecode\n"
-              << "  --trace-vm   Trace VM execution\n"
+              << "  --trace-vm   Record run-vm's instructions in a binary ring, <file>.trace (see trace-dump)\n"
+              << "  --trace-file <file> Trace run-vm into <file> (implies --trace-vm)\n"
+              << "  --trace-every <n> Record one instruction in n (default 1)\n"
+              << "  --trace-records <n> Keep the last n records (default 1048576)\n"
+              << "  --profile    Count every instruction run-vm executes; report the hottest and the opcode mix\n"
+              << "  --profile-out <file> Save run-vm's block and branch counts (accumulates across runs)\n"
+              << "  --profile-use <file> Lay out the code for the hot paths recorded in <file>\n"
+              << "  --profile=sample Sample the VM (SIGPROF) and write <file>.folded for flamegraph.pl\n"
+              << "  --profile=alloc Count heap allocations per instruction and source line, and what is live at the end\n"
+              << "  --hw-counters Report cycles, instructions, branch/cache/TLB misses per bytecode instruction (run-vm, Linux)\n"
+              << "  --time-phases Report wall/CPU time, allocations and peak RSS per compiler phase and pass\n"
+              << "  --time-phases-json <file> The same as JSON, for tracking compile times (implies --time-phases)\n"
+              << "  --timeline <file> Write compile, task and capsule-run spans as Chrome trace JSON (Perfetto)\n"
+              << "  --timeline-min <us> Leave out spans shorter than this (default 0)\n"
+              << "  --flush <policy> When say/echo output is written: line, size[:bytes], time[:ms] or explicit\n"
+              << "               (default: line on a terminal, else size:1048576)\n"
+              << "  --input <file> run-batch's records, one per line; each run sees its line in the global `record`\n"
+              << "  --jobs <n>   run-batch threads, each with its own VM (default 1; 0: one per core)\n"
+              << "  --watch      Recompile (and re-run with run-vm) on every save\n"
+              << "  --pipeline   Lex, parse and compile on separate threads (large files)\n"
+              << "  --max-depth <n> Reject blocks/parentheses nested deeper than n (default " << kMaxNestingDepth << ")\n"
               << "  --version    Show version\n";
     return 0;
   }
@@ -70,7 +509,21 @@ int main(int argc, char** argv) {
   std::string mode = argv[1];
   std::string target = argc > 2 ? argv[2] : "";
   std::string outFile;
-  bool verbose = false, showAst = false, showBytecode = false, traceVm = false;
+  bool verbose = false, showAst = false, showBytecode = false, watchFile = false, pipelined = false;
+  size_t maxDepth = kMaxNestingDepth;
+  std::string profile, profileOut, profileUse, traceSource;
+  TraceOptions trace;
+  bool traceVm = false;
+  uint64_t traceLast = 0;
+  std::string timelineFile;
+  bool hwCounters = false, timePhases = false;
+  std::string phasesJson;
+  size_t ngrams = 0, top = 20;
+  bool staticOnly = false;
+  uint64_t timelineMin = 0;
+  std::string flushPolicy;
+  std::string batchInput;
+  unsigned jobs = 1;
 
   for (int i = 3; i < argc; ++i) {
     std::string arg = argv[i];
@@ -79,38 +532,130 @@ int main(int argc, char** argv) {
     else if (arg == "--show-ast") showAst = true;
     else if (arg == "--show-bytecode") showBytecode = true;
     else if (arg == "--trace-vm") traceVm = true;
+    else if (arg == "--trace-file" && i + 1 < argc) trace.file = argv[++i];
+    else if (arg == "--trace-every" && i + 1 < argc) trace.every = std::stoull(argv[++i]);
+    else if (arg == "--trace-records" && i + 1 < argc) trace.records = std::stoull(argv[++i]);
+    else if (arg == "--source" && i + 1 < argc) traceSource = argv[++i];
+    else if (arg == "--last" && i + 1 < argc) traceLast = std::stoull(argv[++i]);
+    else if (arg == "--watch") watchFile = true;
+    else if (arg == "--flush" && i + 1 < argc) flushPolicy = argv[++i];
+    else if (arg == "--input" && i + 1 < argc) batchInput = argv[++i];
+    else if (arg == "--jobs" && i + 1 < argc) jobs = unsigned(std::stoul(argv[++i]));
+    else if (arg == "--hw-counters") hwCounters = true;
+    else if (arg == "--time-phases") timePhases = true;
+    else if (arg == "--ngrams" && i + 1 < argc) ngrams = std::stoul(argv[++i]);
+    else if (arg == "--static") staticOnly = true;
+    else if (arg == "--top" && i + 1 < argc) top = std::stoul(argv[++i]);
+    else if (arg == "--time-phases-json" && i + 1 < argc) phasesJson = argv[++i];
+    else if (arg == "--timeline" && i + 1 < argc) timelineFile = argv[++i];
+    else if (arg == "--timeline-min" && i + 1 < argc) timelineMin = std::stoull(argv[++i]);
+    else if (arg == "--pipeline") pipelined = true;
+    else if (arg == "--profile") profile = "count";
+    else if (arg.rfind("--profile=", 0) == 0) profile = arg.substr(10);
+    else if (arg == "--profile-out" && i + 1 < argc) profileOut = argv[++i];
+    else if (arg == "--profile-use" && i + 1 < argc) profileUse = argv[++i];
+    else if (arg == "--max-depth" && i + 1 < argc) maxDepth = std::stoul(argv[++i]);
     else if (arg == "--version") {
-      std::cout << "Triad Compiler v0.9.1\n";
+      std::cout << "Triad Compiler v" << kTriadcVersion << "\n";
       return 0;
     }
   }
 
+  if (traceVm && trace.file.empty()) trace.file = (target == "-" ? std::string("stdin") : target) + ".trace";
+  std::optional<TimelineOutput> timeline;
+  if (!timelineFile.empty()) timeline.emplace(timelineFile, timelineMin);
+
   try {
+    if (!flushPolicy.empty()) output_config() = OutputConfig::parse(flushPolicy);
+    if (mode == "analyze") {
+      if (ngrams == 0) throw std::runtime_error("analyze needs --ngrams <n> (2 to " + std::to_string(NgramStats::kMaxN) + ")");
+      analyze_ngrams(target, ngrams, staticOnly, top, maxDepth);
+      return 0;
+    }
+    if (mode == "trace-dump") {
+      trace_dump(target, traceSource, traceLast, maxDepth);
+      return 0;
+    }
     if (mode == "run-tests") {
-      run_tests(verbose);
+      run_tests(verbose, maxDepth);
       return 0;
     }
+    if (watchFile) watch(target, mode, verbose, trace, maxDepth);
 
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
+    // Files are mapped for the whole run: tokens and diagnostics point into
+    // the buffer. "-" streams stdin through the parser in a single pass.
+    const bool fromStdin = target == "-";
+    PhaseTimes phases(timePhases || !phasesJson.empty());
+    SourceBuffer source;
+    if (!fromStdin) source = phases.time("read", [&] { return SourceBuffer::open(target); });
+    Chunk ch;
+    {
+      TimelineSpan span("compile", "compile");
+      if (span.recording()) span.detail(fromStdin ? "stdin" : pipelined ? "pipelined" : "sequential");
+      if (phases.enabled() && !fromStdin && !pipelined) {
+        // Lexed ahead of the parser so that each is timed on its own. An
+        // error is reported as the one-pass compile reports it.
+        try {
+          const std::vector<Token> toks = phases.time("lex", [&] { return Lexer(source.view()).run(); });
+          ch = phases.time("parse", [&] { return parse_tokens(source.view(), toks, maxDepth); });
+        } catch (const std::exception&) {
+          ch = parse_to_chunk(source.view(), maxDepth);
+        }
+      } else {
+        ch = phases.time(fromStdin ? "read+lex+parse" : "lex+parse (pipelined)", [&] {
+          return fromStdin ? parse_to_chunk(std::cin, maxDepth)
+               : pipelined ? parse_to_chunk_pipelined(source.view(), maxDepth)
+                           : parse_to_chunk(source.view(), maxDepth);
+        });
+      }
+    }
 
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code().size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
+    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions, "
+                           << ch.lines.bytes() << " bytes of line table]\n";
+    // Profiles are keyed by the code as compiled, so a run that uses one
+    // cannot record one.
+    if (!profileOut.empty() && !profileUse.empty())
+      throw std::runtime_error("--profile-out and --profile-use cannot be combined");
+    if (!profileUse.empty()) phases.time("pass: pgo layout", [&] { use_profile(ch, profileUse, verbose); });
+    if (phases.enabled()) {
+      std::cerr << "[phases] " << (fromStdin ? "stdin" : target) << "\n";
+      phases.write_table(std::cerr);
+      if (!phasesJson.empty()) {
+        std::ofstream f(phasesJson);
+        if (!f) throw std::runtime_error("Cannot write to: " + phasesJson);
+        phases.write_json(f, kTriadcVersion, fromStdin ? "-" : target, source.view().size());
+      }
+    }
+    if (showBytecode) dump_chunk(ch);
     if (showAst) {
       std::cout << "[AST dump not yet implemented]\n";
       // ASTNode* ast = parse_to_ast(src); ast->dump();
     }
 
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
+    if (!profile.empty() && profile != "sample" && profile != "count" && profile != "alloc") throw std::runtime_error("Unknown profiler: " + profile);
+    if (hwCounters && (!profile.empty() || !profileOut.empty()))
+      throw std::runtime_error("--hw-counters measures a plain run; it cannot be combined with --profile");
+    if (mode == "run-vm" && hwCounters) {
+      hw_vm(ch, trace, target);
+    } else if (mode == "run-vm" && profile == "alloc") {
+      alloc_vm(ch, source.view());
+    } else if (mode == "run-vm" && profile == "sample") {
+      profile_vm(ch, source.view(), target);
+    } else if (mode == "run-vm" && (profile == "count" || !profileOut.empty())) {
+      count_vm(ch, source.view(), trace, target, profile == "count", profileOut);
+    } else if (mode == "run-vm") {
+      run_vm(ch, trace, target);
+    } else if (mode == "run-batch") {
+      if (fromStdin && batchInput == "-") throw std::runtime_error("run-batch cannot read both the program and its records from stdin");
+      if (run_batch(ch, batchInput, jobs) != 0) return 1;
     } else if (mode == "run-ast") {
-      run_ast(src);
+      run_ast(source.view());
     } else if (mode == "emit-nasm") {
-      std::string asm_code = emit_nasm(ch); // stub
+      std::string asm_code = emit_nasm(ch);
       if (!outFile.empty()) emit_to_file(asm_code, outFile);
       else std::cout << asm_code;
     } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
+      std::string llvm_code = emit_llvm(ch);
       if (!outFile.empty()) emit_to_file(llvm_code, outFile);
       else std::cout << llvm_code;
     } else {
@@ -124,1382 +669,3 @@ int main(int argc, char** argv) {
 
   return 0;
 }
-    std::cerr << "Error: No input file specified.\n";
-    return 1;
-  }
-  std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-      // ASTNode* ast = parse_to_ast(src); ast->dump();
-    }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-      std::string asm_code = emit_nasm(ch); // stub
-      if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-   std::string asm_code = emit_nasm(ch); // stub
-      if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-   std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-  std::cout << "Triad Compiler v0.9.1\n";
-  std::string mode = argv[1];
-  std::string target = argc > 2 ? argv[2] : "";
-  std::string outFile;
-  bool verbose = false, showAst = false, showBytecode = false, traceVm
-	  = false;
-  for (int i = 3; i < argc; ++i) {
-	  std::string arg = argv[i];
-      if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-    else if (arg == "--verbose") verbose = true;
-	else if (arg == "--show-ast") showAst = true;
-      else if (arg == "--show-bytecode") showBytecode = true;
-    else if (arg == "--trace-vm") traceVm = true;
-    else if (arg == "--version") {
-      std::cout << "Triad Compiler v0.9.1\n";
-      return 0;
-    } else {
-      std::cerr << "Unknown argument: " << arg << "\n";
-      return 1;
-    }
-    }
-  try {
-    if (mode == "run-tests") {
-      run_tests(verbose);
-      return 0;
-    }
-    if (target.empty()) {
-      std::cerr << "Error: No input file specified.\n";
-      return 1;
-    }
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-      // ASTNode* ast = parse_to_ast(src); ast->dump();
-    }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-        std::string asm_code = emit_nasm(ch); // stub
-        if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-   std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-   std::string asm_code = emit_nasm(ch); // stub
-      if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-   std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-   std::string asm_code = emit_nasm(ch); // stub
-      if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-   std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-   return 0;
-    }
-    if (target.empty()) {
-      std::cerr << "Error: No input file specified.\n";
-      return 1;
-    }
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-      // ASTNode* ast = parse_to_ast(src); ast->dump();
-    }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-        std::string asm_code = emit_nasm(ch); // stub
-        if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-   return 0;
-    }
-    if (target.empty()) {
-      std::cerr << "Error: No input file specified.\n";
-      return 1;
-    }
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-      // ASTNode* ast = parse_to_ast(src); ast->dump();
-    }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-        std::string asm_code = emit_nasm(ch); // stub
-        if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-   return 0;
-    }
-    if (target.empty()) {
-      std::cerr << "Error: No input file specified.\n";
-      return 1;
-    }
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-      // ASTNode* ast = parse_to_ast(src); ast->dump();
-    }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-        std::string asm_code = emit_nasm(ch); // stub
-        if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-   return 0;
-	}
-    }
-    if (target.empty()) {
-      std::cerr << "Error: No input file specified.\n";
-      return 1;
-    }
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-      // ASTNode* ast = parse_to_ast(src); ast->dump();
-    }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-        std::string asm_code = emit_nasm(ch); // stub
-        if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-  
-  std::cout << "Triad Compiler v0.9.1\n";
-  if (argc < 2) {
-    std::cout << "Usage: triadc <mode> <file.triad | dir> [options]\n"
-              << "Modes:\n"
-              << "  run-vm       Execute via VM\n"
-              << "  run-ast      Execute via AST interpreter\n"
-              << "  emit-nasm    Emit NASM assembly\n"
-              << "  emit-llvm    Emit LLVM IR\n"
-              << "  run-tests    Execute all .triad files in /tests\n"
-              << "Options:\n"
-              << "  -o <file>    Output to file\n"
-              << "  --verbose    Show debug info\n"
-              << "  --show-ast   Print AST\n"
-              << "  --show-bytecode Print bytecode\n"
-		<< "  --trace-vm   Trace
-        << "  --version    Show version\n";
-    return 0;
-  }
-  std::string mode = argv[1];
-  std::string target = argc > 2 ? argv[2] : "";
-  std::string outFile;
-  bool verbose = false, showAst = false, showBytecode = false, traceVm = false;
-  for (int i = 3; i < argc; ++i) {
-    std::string arg = argv[i];
-    if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-    else if (arg == "--verbose") verbose = true;
-    else if (arg == "--show-ast") showAst = true;
-    else if (arg == "--show-bytecode") showBytecode = true;
-    else if (arg == "--trace-vm") traceVm = true;
-    else if (arg == "--version") {
-      std::cout << "Triad Compiler v0.9.1\n";
-      return 0;
-    }
-  }
-  try {
-    if (mode == "run-tests") {
-      run_tests(verbose);
-      return 0;
-    }
-    if (target.empty()) {
-      std::cerr << "Error: No input file specified.\n";
-      return 1;
-    }
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-      // ASTNode* ast = parse_to_ast(src); ast->dump();
-    }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-      std::string asm_code = emit_nasm(ch); // stub
-      if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-  std::cout << "Triad Compiler v0.9.1\n";
-  if (argc < 2) {
-    std::cout << "Usage: triadc <mode> <file.triad | dir> [options]\n"
-              << "Modes:\n"
-              << "  run-vm       Execute via VM\n"
-              << "  run-ast      Execute via AST interpreter\n"
-              << "  emit-nasm    Emit NASM assembly\n"
-              << "  emit-llvm    Emit LLVM IR\n"
-              << "  run-tests    Execute all .triad files in /tests\n"
-              << "Options:\n"
-              << "  -o <file>    Output to file\n"
-              << "  --verbose    Show debug info\n"
-              << "  --show-ast   Print AST\n"
-		<< "  --show-bytecode Print bytecode\n"
-		<< "  --trace-vm   Trace
-        << "  --version    Show version\n";
-    return 0;
-  }
-  std::string mode = argv[1];
-  std::string target = argc > 2 ? argv[2] : "";
-  std::string outFile;
-  bool verbose = false, showAst = false, showBytecode = false, traceVm = false;
-  for (int i = 3; i < argc; ++i) {
-    std::string arg = argv[i];
-    if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-    else if (arg == "--verbose") verbose = true;
-    else if (arg == "--show-ast") showAst = true;
-    else if (arg == "--show-bytecode") showBytecode = true;
-    else if (arg == "--trace-vm") traceVm = true;
-    else if (arg == "--version") {
-      std::cout << "Triad Compiler v0.9.1\n";
-      return 0;
-    }
-  }
-  try {
-    if (mode == "run-tests") {
-      run_tests(verbose);
-      return 0;
-    }
-    if (target.empty()) {
-      std::cerr << "Error: No input file specified.\n";
-      return 1;
-    }
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-	if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-      // ASTNode* ast = parse_to_ast(src); ast->dump();
-    }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-      std::string asm_code = emit_nasm(ch); // stub
-      if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-	  else std::cout << llvm_code; // Print to stdout if no output file specified
-      } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-	}
-    } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-	return 0;
-    }
-  std::cout << "Triad Compiler v0.9.1\n";
-  if (argc < 2) {
-    std::cout << "Usage: triadc <mode> <file.triad | dir> [options]\n"
-              << "Modes:\n"
-              << "  run-vm       Execute via VM\n"
-              << "  run-ast      Execute via AST interpreter\n"
-              << "  emit-nasm    Emit NASM assembly\n"
-              << "  emit-llvm    Emit LLVM IR\n"
-              << "  run-tests    Execute all .triad files in /tests\n"
-              << "Options:\n"
-              << "  -o <file>    Output to file\n"
-              << "  --verbose    Show debug info\n"
-              << "  --show-ast   Print AST\n"
-		<< "  --show-bytecode Print bytecode\n"
-        << "  --trace-vm   Trace VM execution\n"
-              << "  --version    Show version\n";
-    return 0;
-  }
-  std::string mode = argv[1];
-  std::string target = argc > 2 ? argv[2] : "";
-  std::string outFile;
-  bool verbose = false, showAst = false, showBytecode = false, traceVm = false;
-  for (int i = 3; i < argc; ++i) {
-    std::string arg = argv[i];
-    if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-    else if (arg == "--verbose") verbose = true;
-    else if (arg == "--show-ast") showAst = true;
-    else if (arg == "--show-bytecode") showBytecode = true;
-    else if (arg == "--trace-vm") traceVm = true;
-    else if (arg == "--version") {
-      std::cout << "Triad Compiler v0.9.1\n";
-      return 0;
-    }
-  }
-  try {
-    if (mode == "run-tests") {
-      run_tests(verbose);
-      return 0;
-    }
-    if (target.empty()) {
-      std::cerr << "Error: No input file specified.\n";
-      return 1;
-    }
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
-	if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-      // ASTNode* ast = parse_to_ast(src); ast->dump();
-    }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-      std::string asm_code = emit_nasm(ch); // stub
-      if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-	  if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-	}
-    } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-	return 0;
-	}
-    std::cout << "Triad Compiler v0.9.1\n";
-  if (argc < 2) {
-    std::cout << "Usage: triadc <mode> <file.triad | dir> [options]\n"
-              << "Modes:\n"
-              << "  run-vm       Execute via VM\n"
-              << "  run-ast      Execute via AST interpreter\n"
-              << "  emit-nasm    Emit NASM assembly\n"
-              << "  emit-llvm    Emit LLVM IR\n"
-              << "  run-tests    Execute all .triad files in /tests\n"
-              << "Options:\n"
-              << "  -o <file>    Output to file\n"
-              << "  --verbose    Show debug info\n"
-              << "  --show-ast   Print AST\n"
-        << "  --show-bytecode Print bytecode\n"
-		<< "  --trace-vm   Trace
-        << "  --version    Show version\n";
-    return 0;
-  }
-  std::string mode = argv[1];
-  std::string target = argc > 2 ? argv[2] : "";
-  std::string outFile;
-  bool verbose = false, showAst = false, showBytecode = false, traceVm = false;
-  for (int i = 3; i < argc; ++i) {
-    std::string arg = argv[i];
-    if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-    else if (arg == "--verbose") verbose = true;
-    else if (arg == "--show-ast") showAst = true;
-    else if (arg == "--show-bytecode") showBytecode = true;
-    else if (arg == "--trace-vm") traceVm = true;
-    else if (arg == "--version") {
-      std::cout << "Triad Compiler v0.9.1\n";
-      return 0;
-    }
-  }
-  try {
-    if (mode == "run-tests") {
-      run_tests(verbose);
-      return 0;
-    }
-    if (target.empty()) {
-      std::cerr << "Error: No input file specified.\n";
-      return 1;
-    }
-    std::string src = slurp(target);
-	Chunk ch = parse_to_chunk(src);
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-      // ASTNode* ast = parse_to_ast(src); ast->dump();
-    }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-      std::string asm_code = emit_nasm(ch); // stub
-      if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-#include <iostream>
-#include <string>
-#include <filesystem>
-#include "chunk.h"
-#include "vm.h"
-#include "ast.h"
-#include "nasm.h"
-#include "llvm.h"
-#include "utils.h"
-  void run_tests(bool verbose) {
-  std::cout << "Running tests in /tests directory...\n";
-  for (const auto& entry : std::filesystem::directory_iterator("tests")) {
-	  if (!entry.is_regular_file()) continue; // Skip directories
-      if (entry.path().extension() == ".triad") {
-      std::string filename = entry.path().string();
-      std::cout << "Running test: " << filename << "\n";
-      std::string src = slurp(filename);
-      if (verbose) std::cout << "[Read " << src.size() << " bytes from " << filename << "]\n";
-      
-	  // Parse and run the test
-      Chunk ch = parse_to_chunk(src);
-      if (verbose) std::cout << "[Parsed chunk with " << ch.code().size() << " instructions]\n";
-      
-      // Run the VM
-      run_vm(ch, false); // No tracing for tests
-      
-      // Optionally, you can check expected output here
-      // For now, just print success
-      std::cout << "Test passed: " << filename << "\n";
-	  }
-  }
-  std::cout << "All tests completed.\n";
-  }
-  int main(int argc, char* argv[]) {
-	  std::cout << "Triad Compiler v0.9.1\n";
-      if (argc < 2) {
-    std::cout << "Usage: triadc <mode> <file.triad | dir> [options]\n"
-              << "Modes:\n"
-              << "  run-vm       Execute via VM\n"
-              << "  run-ast      Execute via AST interpreter\n"
-              << "  emit-nasm    Emit NASM assembly\n"
-              << "  emit-llvm    Emit LLVM IR\n"
-              << "  run-tests    Execute all .triad files in /tests\n"
-              << "Options:\n"
-              << "  -o <file>    Output to file\n"
-              << "  --verbose    Show debug info\n"
-		<< "  --show-ast   Print AST\n"
-        << "  --show-bytecode Print bytecode\n"
-		<< "  --trace-vm   Trace
-        << "  --version    Show version\n";
-    return 0;
-	  }
-	  std::string mode = argv[1];
-	  std::string target = argc > 2 ? argv[2] : "";
-	  std::string outFile;
-	  bool verbose = false, showAst = false, showBytecode = false, traceVm = false;
-      for (int i = 3; i < argc; ++i) {
-    std::string arg = argv[i];
-    if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-    else if (arg == "--verbose") verbose = true;
-    else if (arg == "--show-ast") showAst = true;
-    else if (arg == "--show-bytecode") showBytecode = true;
-    else if (arg == "--trace-vm") traceVm = true;
-    else if (arg == "--version") {
-      std::cout << "Triad Compiler v0.9.1\n";
-      return 0;
-    } else {
-      std::cerr << "Unknown argument: " << arg << "\n";
-      return 1;
-	}
-    }
-  try {
-    if (mode == "run-tests") {
-      run_tests(verbose);
-      return 0;
-    }
-	if (target.empty()) {
-        std::cerr << "Error: No input file specified.\n";
-      return 1;
-    }
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-      // ASTNode* ast = parse_to_ast(src); ast->dump();
-    }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-      std::string asm_code = emit_nasm(ch); // stub
-      if (!outFile.empty()) emit_to_file(asm_code, outFile);
-	  else std::cout << asm_code;
-      } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-	  }
-      } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-	return 1;
-    }
-  return 0;
-  }
-  std::cout << "Triad Compiler v0.9.1\n";
-  if (argc < 2) {
-    std::cout << "Usage: triadc <mode> <file.triad | dir> [options]\n"
-              << "Modes:\n"
-              << "  run-vm       Execute via VM\n"
-              << "  run-ast      Execute via AST interpreter\n"
-              << "  emit-nasm    Emit NASM assembly\n"
-              << "  emit-llvm    Emit LLVM IR\n"
-              << "  run-tests    Execute all .triad files in /tests\n"
-              << "Options:\n"
-              << "  -o <file>    Output to file\n"
-              << "  --verbose    Show debug info\n"
-        << "  --show-ast   Print AST\n"
-        << "  --show-bytecode Print bytecode\n"
-        << "  --trace-vm   Trace
-        << "  --version    Show version\n";
-	return 0;
-    }
-  std::string mode = argv[1];
-  std::string target = argc > 2 ? argv[2] : "";
-  std::string outFile;
-  bool verbose = false, showAst = false, showBytecode = false, traceVm = false;
-  for (int i = 3; i < argc; ++i) {
-    std::string arg = argv[i];
-    if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-    else if (arg == "--verbose") verbose = true;
-    else if (arg == "--show-ast") showAst = true;
-    else if (arg == "--show-bytecode") showBytecode = true;
-    else if (arg == "--trace-vm") traceVm = true;
-    else if (arg == "--version") {
-      std::cout << "Triad Compiler v0.9.1\n";
-      return 0;
-    } else {
-      std::cerr << "Unknown argument: " << arg << "\n";
-      return 1;
-    }
-  }
-  try {
-    if (mode == "run-tests") {
-      run_tests(verbose);
-      return 0;
-    }
-    if (target.empty()) {
-      std::cerr << "Error: No input file specified.\n";
-      return 1;
-    }
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-      // ASTNode* ast = parse_to_ast(src); ast->dump();
-    }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-      std::string asm_code = emit_nasm(ch); // stub
-      if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-	}
-	else if (mode == "emit-llvm") {
-        std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-  std::cout << "Triad Compiler v0.9.1\n";
-  if (argc < 2) {
-    std::cout << "Usage: triadc <mode> <file.triad | dir> [options]\n"
-              << "Modes:\n"
-              << "  run-vm       Execute via VM\n"
-              << "  run-ast      Execute via AST interpreter\n"
-              << "  emit-nasm    Emit NASM assembly\n"
-              << "  emit-llvm    Emit LLVM IR\n"
-              << "  run-tests    Execute all .triad files in /tests\n"
-              << "Options:\n"
-              << "  -o <file>    Output to file\n"
-              << "  --verbose    Show debug info\n"
-        << "  --show-ast   Print AST\n"
-		<< "  --show-bytecode Print bytecode\n"
-        << "  --trace-vm   Trace VM execution\n"
-              << "  --version    Show version\n";
-    return 0;
-  }
-  std::string mode = argv[1];
-  std::string target = argc > 2 ? argv[2] : "";
-  std::string outFile;
-  bool verbose = false, showAst = false, showBytecode = false, traceVm = false;
-  for (int i = 3; i < argc; ++i) {
-    std::string arg = argv[i];
-    if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-    else if (arg == "--verbose") verbose = true;
-    else if (arg == "--show-ast") showAst = true;
-    else if (arg == "--show-bytecode") showBytecode = true;
-    else if (arg == "--trace-vm") traceVm = true;
-    else if (arg == "--version") {
-      std::cout << "Triad Compiler v0.9.1\n";
-	  return 0;
-      } else {
-      std::cerr << "Unknown argument: " << arg << "\n";
-      return 1;
-	}
-    try {
-    if (mode == "run-tests") {
-      run_tests(verbose);
-      return 0;
-    }
-    if (target.empty()) {
-      std::cerr << "Error: No input file specified.\n";
-      return 1;
-    }
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-      // ASTNode* ast = parse_to_ast(src); ast->dump();
-    }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-      std::string asm_code = emit_nasm(ch); // stub
-	  if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-	}
-    } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-  std::cout << "Triad Compiler v0.9.1\n";
-  if (argc < 2) {
-    std::cout << "Usage: triadc <mode> <file.triad | dir> [options]\n"
-              << "Modes:\n"
-              << "  run-vm       Execute via VM\n"
-              << "  run-ast      Execute via AST interpreter\n"
-              << "  emit-nasm    Emit NASM assembly\n"
-              << "  emit-llvm    Emit LLVM IR\n"
-              << "  run-tests    Execute all .triad files in /tests\n"
-              << "Options:\n"
-              << "  -o <file>    Output to file\n"
-              << "  --verbose    Show debug info\n"
-        << "  --show-ast   Print AST\n"
-        << "  --show-bytecode Print bytecode\n"
-		<< "  --trace-vm   Trace
-        << "  --version    Show version\n";
-    return 0;
-  }
-  std::string mode = argv[1];
-  std::string target = argc > 2 ? argv[2] : "";
-  std::string outFile;
-  bool verbose = false, showAst = false, showBytecode = false, traceVm = false;
-  for (int i = 3; i < argc; ++i) {
-    std::string arg = argv[i];
-    if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-    else if (arg == "--verbose") verbose = true;
-    else if (arg == "--show-ast") showAst = true;
-    else if (arg == "--show-bytecode") showBytecode = true;
-    else if (arg == "--trace-vm") traceVm = true;
-    else if (arg == "--version") {
-      std::cout << "Triad Compiler v0.9.1\n";
-      return 0;
-    } else {
-      std::cerr << "Unknown argument: " << arg << "\n";
-	  return 1;
-	}
-    try {
-    if (mode == "run-tests") {
-      run_tests(verbose);
-      return 0;
-    }
-    if (target.empty()) {
-		std::cerr << "Error: No input file specified.\n";
-        return 1;
-    }
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-      // ASTNode* ast = parse_to_ast(src); ast->dump();
-    }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-      std::string asm_code = emit_nasm(ch); // stub
-      if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-		std::cerr << "Unknown mode: " << mode << "\n";
-        return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-  std::cout << "Triad Compiler v0.9.1\n";
-  if (argc < 2) {
-    std::cout << "Usage: triadc <mode> <file.triad | dir> [options]\n"
-              << "Modes:\n"
-              << "  run-vm       Execute via VM\n"
-              << "  run-ast      Execute via AST interpreter\n"
-              << "  emit-nasm    Emit NASM assembly\n"
-              << "  emit-llvm    Emit LLVM IR\n"
-              << "  run-tests    Execute all .triad files in /tests\n"
-              << "Options:\n"
-              << "  -o <file>    Output to file\n"
-              << "  --verbose    Show debug info\n"
-        << "  --show-ast   Print AST\n"
-		<< "  --show-bytecode Print bytecode\n"
-        << "  --trace-vm   Trace VM execution\n"
-              << "  --version    Show version\n";
-    return 0;
-  }
-  std::string mode = argv[1];
-  std::string target = argc > 2 ? argv[2] : "";
-  std::string outFile;
-  bool verbose = false, showAst = false, showBytecode = false, traceVm = false;
-  for (int i = 3; i < argc; ++i) {
-    std::string arg = argv[i];
-    if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-    else if (arg == "--verbose") verbose = true;
-    else if (arg == "--show-ast") showAst = true;
-    else if (arg == "--show-bytecode") showBytecode = true;
-    else if (arg == "--trace-vm") traceVm = true;
-    else if (arg == "--version") {
-      std::cout << "Triad Compiler v0.9.1\n";
-      return 0;
-    } else {
-      std::cerr << "Unknown argument: " << arg << "\n";
-	  return 1;
-	}
-    try {
-    if (mode == "run-tests") {
-      run_tests(verbose);
-      return 0;
-    }
-    if (target.empty()) {
-		std::cerr << "Error: No input file specified.\n";
-        return 1;
-    }
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
-	if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-	  // ASTNode* ast = parse_to_ast(src); ast->dump();
-      }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-	}
-	else if (mode == "emit-nasm") {
-        std::string asm_code = emit_nasm(ch); // stub
-      if (!outFile.empty()) emit_to_file(asm_code, outFile);
-	  else std::cout << asm_code; // Print to stdout if no output file specified
-      } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-	  if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-	  return 1;
-	  }
-      } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-	return 1;
-    }
-  return 0;
-  }
-  std::cout << "Triad Compiler v0.9.1\n";
-  if (argc < 2) {
-	  std::cout << "Usage: triadc <mode> <file.triad | dir> [options]\n"
-          << "Modes:\n"
-              << "  run-vm       Execute via VM\n"
-              << "  run-ast      Execute via AST interpreter\n"
-		  << "  emit-nasm    Emit NASM assembly\n"
-          << "  emit-llvm    Emit LLVM IR\n"
-              << "  run-tests    Execute all .triad files in /tests\n"
-              << "Options:\n"
-		  << "  -o <file>    Output to file\n"
-          << "  --verbose    Show debug info\n"
-		  << "  --show-ast   Print AST\n"
-		  << "  --show-bytecode Print bytecode\n"
-          << "  --trace-vm   Trace VM execution\n"
-		  << "  --version    Show version\n";
-	  return 0;
-  }
-  std::string mode = argv[1];
-  std::string target = argc > 2 ? argv[2] : "";
-  std::string outFile;
-  bool verbose = false, showAst = false, showBytecode = false, traceVm = false;
-  for (int i = 3; i < argc; ++i) {
-    std::string arg = argv[i];
-	if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-    else if (arg == "--verbose") verbose = true;
-    else if (arg == "--show-ast") showAst = true;
-	else if (arg == "--show-bytecode") showBytecode = true;
-	else if (arg == "--trace-vm") trace
-        Vm = true;
-    else if (arg == "--version") {
-      std::cout << "Triad Compiler v0.9.1\n";
-      return 0;
-    } else {
-      std::cerr << "Unknown argument: " << arg << "\n";
-      return 1;
-    }
-  }
-  try {
-      if (mode == "run-tests") {
-      run_tests(verbose);
-      return 0;
-    }
-    if (target.empty()) {
-      std::cerr << "Error: No input file specified.\n";
-      return 1;
-    }
-    std::string src = slurp(target);
-	Chunk ch = parse_to_chunk(src);
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-	  // ASTNode* ast = parse_to_ast(src); ast->dump();
-      }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-      std::string asm_code = emit_nasm(ch); // stub
-	  if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-	  else std::cout << llvm_code; // Print to stdout if no output file specified
-      } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-	}
-    } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-  std::cout << "Triad Compiler v0.9.1\n";
-  if (argc < 2) {
-      std::cout << "Usage: triadc <mode> <file.triad | dir> [options]\n"
-              << "Modes:\n"
-              << "  run-vm       Execute via VM\n"
-              << "  run-ast      Execute via AST interpreter\n"
-		  << "  emit-nasm    Emit NASM assembly\n"
-          << "  emit-llvm    Emit LLVM IR\n"
-              << "  run-tests    Execute all .triad files in /tests\n"
-              << "Options:\n"
-              << "  -o <file>    Output to file\n"
-		  << "  --verbose    Show debug info\n"
-		  << "  --show-ast   Print AST\n"
-          << "  --show-bytecode Print bytecode\n"
-		  << "  --trace-vm   Trace
-		  << "  --version    Show version\n";
-	  return 0;
-  }
-  std::string mode = argv[1];
-  std::string target = argc > 2 ? argv[2] : "";
-  std::string outFile;
-  bool verbose = false, showAst = false, showBytecode = false, traceVm = false;
-  for (int i = 3; i < argc; ++i) {
-    std::string arg = argv[i];
-    if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-    else if (arg == "--verbose") verbose = true;
-	else if (arg == "--show-ast") showAst = true;
-    else if (arg == "--show-bytecode") showBytecode = true;
-	else if (arg == "--trace-vm") trace
-        Vm = true;
-    else if (arg == "--version") {
-      std::cout << "Triad Compiler v0.9.1\n";
-      return 0;
-    } else {
-      std::cerr << "Unknown argument: " << arg << "\n";
-      return 1;
-    }
-  }
-  try {
-    if (mode == "run-tests") {
-      run_tests(verbose);
-      return 0;
-    }
-	if (target.empty()) {
-        std::cerr << "Error: No input file specified.\n";
-      return 1;
-    }
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-	  // ASTNode* ast = parse_to_ast(src); ast->dump();
-      }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-      std::string asm_code = emit_nasm(ch); // stub
-      if (!outFile.empty()) emit_to_file(asm_code, outFile);
-	  else std::cout << asm_code; // Print to stdout if no output file specified
-      } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-      if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-	  }
-      } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-	return 1;
-    }
-  return 0;
-  }
-  std::cout << "Triad Compiler v0.9.1\n";
-  if (argc < 2) {
-    std::cout << "Usage: triadc <mode> <file.triad | dir> [options]\n"
-              << "Modes:\n"
-              << "  run-vm       Execute via VM\n"
-		<< "  run-ast      Execute via AST interpreter\n"
-        << "  emit-nasm    Emit NASM assembly\n"
-              << "  emit-llvm    Emit LLVM IR\n"
-              << "  run-tests    Execute all .triad files in /tests\n"
-              << "Options:\n"
-              << "  -o <file>    Output to file\n"
-              << "  --verbose    Show debug info\n"
-        << "  --show-ast   Print AST\n"
-		<< "  --show-bytecode Print bytecode\n"
-        << "  --trace-vm   Trace VM execution\n"
-              << "  --version    Show version\n";
-    return 0;
-  }
-  std::string mode = argv[1];
-  std::string target = argc > 2 ? argv[2] : "";
-  std::string outFile;
-  bool verbose = false, showAst = false, showBytecode = false, traceVm = false;
-  for (int i = 3; i < argc; ++i) {
-    std::string arg = argv[i];
-    if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-    else if (arg == "--verbose") verbose = true;
-    else if (arg == "--show-ast") showAst = true;
-	else if (arg == "--show-bytecode") showBytecode = true;
-	else if (arg == "--trace-vm") trace
-        Vm = true;
-    else if (arg == "--version") {
-      std::cout << "Triad Compiler v0.9.1\n";
-      return 0;
-    } else {
-      std::cerr << "Unknown argument: " << arg << "\n";
-      return 1;
-    }
-  }
-  try {
-    if (mode == "run-tests") {
-      run_tests(verbose);
-      return 0;
-	}
-    if (target.empty()) {
-      std::cerr << "Error: No input file specified.\n";
-      return 1;
-    }
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-	  // ASTNode* ast = parse_to_ast(src); ast->dump();
-      }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-      std::string asm_code = emit_nasm(ch); // stub
-      if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-    } else if (mode == "emit-llvm") {
-		std::string llvm_code = emit_llvm(ch); // stub
-        if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-  std::cout << "Triad Compiler v0.9.1\n";
-  if (argc < 2) {
-    std::cout << "Usage: triadc <mode> <file.triad | dir> [options]\n"
-              << "Modes:\n"
-              << "  run-vm       Execute via VM\n"
-              << "  run-ast      Execute via AST interpreter\n"
-              << "  emit-nasm    Emit NASM assembly\n"
-              << "  emit-llvm    Emit LLVM IR\n"
-              << "  run-tests    Execute all .triad files in /tests\n"
-		<< "Options:\n"
-        << "  -o <file>    Output to file\n"
-              << "  --verbose    Show debug info\n"
-		<< "  --show-ast   Print AST\n"
-        << "  --show-bytecode Print bytecode\n"
-		<< "  --trace-vm   Trace
-        << "  --version    Show version\n";
-    return 0;
-  }
-  std::string mode = argv[1];
-  std::string target = argc > 2 ? argv[2] : "";
-  std::string outFile;
-  bool verbose = false, showAst = false, showBytecode = false, traceVm = false;
-  for (int i = 3; i < argc; ++i) {
-    std::string arg = argv[i];
-    if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
-    else if (arg == "--verbose") verbose = true;
-    else if (arg == "--show-ast") showAst = true;
-    else if (arg == "--show-bytecode") showBytecode = true;
-    else if (arg == "--trace-vm") traceVm = true;
-    else if (arg == "--version") {
-		std::cout << "Triad Compiler v0.9.1\n";
-        return 0;
-    } else {
-      std::cerr << "Unknown argument: " << arg << "\n";
-      return 1;
-    }
-  }
-  try {
-    if (mode == "run-tests") {
-      run_tests(verbose);
-      return 0;
-    }
-    if (target.empty()) {
-      std::cerr << "Error: No input file specified.\n";
-      return 1;
-    }
-    std::string src = slurp(target);
-    Chunk ch = parse_to_chunk(src);
-    if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-    if (showBytecode) ch.dump(); // Assuming Chunk::dump() exists
-    if (showAst) {
-      std::cout << "[AST dump not yet implemented]\n";
-	  // ASTNode* ast = parse_to_ast(src); ast->dump();
-      }
-    if (mode == "run-vm") {
-      run_vm(ch, traceVm);
-    } else if (mode == "run-ast") {
-      run_ast(src);
-    } else if (mode == "emit-nasm") {
-      std::string asm_code = emit_nasm(ch); // stub
-      if (!outFile.empty()) emit_to_file(asm_code, outFile);
-      else std::cout << asm_code; // Print to stdout if no output file specified
-    } else if (mode == "emit-llvm") {
-      std::string llvm_code = emit_llvm(ch); // stub
-	  if (!outFile.empty()) emit_to_file(llvm_code, outFile);
-      else std::cout << llvm_code; // Print to stdout if no output file specified
-    } else {
-      std::cerr << "Unknown mode: " << mode << "\n";
-      return 1;
-	}
-    } catch (const std::exception& e) {
-    std::cerr << "Error: " << e.what() << "\n";
-    return 1;
-  }
-  return 0;
-  }
-  void run_tests(bool verbose) {
-  std::cout << "Running tests...\n";
-  for (const auto& entry : std::filesystem::directory_iterator("tests")) {
-	  if (entry.is_regular_file() && entry.path().extension() == ".triad") {
-          std::string filename = entry.path().string();
-      std::cout << "Running test: " << filename << "\n";
-      
-      // Read the test file
-      std::string src = slurp(filename);
-      
-      // Parse to chunk
-      Chunk ch = parse_to_chunk(src);
-      if (verbose) std::cout << "[Parsed chunk with " << ch.code.size() << " instructions]\n";
-      
-      // Optionally show bytecode
-      if (verbose) ch.dump(); // Assuming Chunk::dump() exists
-      
-	  // Run the VM
-      try {
-        run_vm(ch, false); // No tracing for tests
-        std::cout << "Test passed: " << filename << "\n";
-      } catch (const std::exception& e) {
-        std::cerr << "Test failed: " << filename << " - " << e.what() << "\n";
-      }
-	  }
@@ -0,0 +1,87 @@
+// TokenStream over an std::istream must produce the same tokens as over the
+// whole text in memory, wherever the read chunks end: small chunk sizes put
+// a boundary inside every token, and padded inputs put number literals
+// across the default 64 KiB chunk.
+#include "triad_token_stream.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace triad;
+
+namespace {
+
+  int failures = 0;
+
+  // One line per token (kind, text, value), or the error that stopped lexing.
+  std::string lex_all(TokenStream& ts) {
+    std::ostringstream out;
+    try {
+      for (;;) {
+        const Token& t = ts.advance();
+        out << int(t.kind) << " '" << ts.text(t) << "' " << t.number << "\n";
+        if (t.kind == TokKind::Eof) break;
+      }
+    } catch (const std::exception& e) {
+      const std::string what = e.what();
+      out << "error: " << what.substr(0, what.find(" at "));
+    }
+    return out.str();
+  }
+
+  std::string in_memory(const std::string& src) {
+    TokenStream ts(src);
+    return lex_all(ts);
+  }
+
+  std::string streamed(const std::string& src, size_t chunk) {
+    std::istringstream in(src);
+    TokenStream ts(in, chunk);
+    return lex_all(ts);
+  }
+
+  void expect_same(const std::string& src, size_t chunk, const std::string& name) {
+    const std::string want = in_memory(src), got = streamed(src, chunk);
+    if (got == want) return;
+    ++failures;
+    std::cerr << "FAIL " << name << " (chunk " << chunk << ")\n--- in memory\n" << want << "\n--- streamed\n" << got << "\n";
+  }
+
+} // namespace
+
+int main() {
+  const std::vector<std::string> sources = {
+    "x = 0x1F\nsay x\n",
+    "y = 1e+5\nsay y\n",
+    "z = 12.5e-3 + 7 * (0xff - 3.25)\n",
+    "say \"a string, with spaces\" // a comment\n/* block\n comment */ name_2 = other\n",
+    "if (a >= 10 and b != 0) { echo a } else { say 1.5E3 }\n",
+  };
+  for (const std::string& src : sources)
+    for (size_t chunk = 1; chunk <= 16; ++chunk) expect_same(src, chunk, src.substr(0, src.find('\n')));
+
+  // Malformed literals: `12e` was once `12` then `e`; it is an error
+  // whether or not a chunk boundary falls inside it.
+  for (const char* bad : {"a = 12e\n", "b = 0x\n", "c = 1e+\n", "d = 12e"}) {
+    if (in_memory(bad).rfind("error: bad number literal") == std::string::npos) {
+      ++failures;
+      std::cerr << "FAIL " << bad << ": accepted\n";
+    }
+    for (size_t chunk = 1; chunk <= 8; ++chunk) expect_same(bad, chunk, bad);
+  }
+
+  // The default chunk size, with the literal cut after each of its bytes.
+  constexpr size_t kChunk = 64 * 1024;
+  for (const std::string lit : {"0x1F", "1e+5", "2.5e-3"}) {
+    for (size_t cut = 1; cut < lit.size(); ++cut) {
+      const std::string head = "v = ";
+      std::string src(kChunk - head.size() - cut, ' ');
+      src += head + lit + "\nsay v\n";
+      expect_same(src, kChunk, lit + " cut after " + std::to_string(cut));
+    }
+  }
+
+  if (failures) std::cerr << failures << " failure(s)\n";
+  return failures ? 1 : 0;
+}
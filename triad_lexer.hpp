@@ -1,22 +1,26 @@
 // triad_lexer.hpp
 // Triad Language Lexer — v1.0
-// C++17, single-file, no deps.
+// C++17, no deps beyond the shared helpers in triad-pro/src.
 
 #pragma once
+#include <algorithm>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
+#include <cstdint>
 #include <stdexcept>
 #include <cctype>
 #include <limits>
 #include <sstream>
+#include "triad-pro/src/triad_perfect_hash.hpp"
+#include "triad-pro/src/triad_scan.hpp"
+#include "triad-pro/src/triad_number.hpp"
+#include "triad-pro/src/triad_lineindex.hpp"
 
-namespace triad {
-
-struct SourcePos {
-    int line = 1;
-    int column = 1;
-};
+// triad::mini: this lexer and triad_min.cpp's front end. triad-pro's lexer
+// has its own Lexer and Token in triad; the helpers both use (scan, phash,
+// scan_number, LineIndex) are the shared ones in triad.
+namespace triad::mini {
 
 enum class TokenType {
     // Structure
@@ -59,25 +63,91 @@ enum class TokenType {
 
 struct Token {
     TokenType type{};
-    std::string lexeme;     // original slice (for identifiers/strings/raw)
-    SourcePos pos{};
+    uint32_t offset = 0;    // window into the source the Lexer was given;
+    uint32_t length = 0;    // strings span their quotes, Eol spans the newline
+    // No line/column here: LineIndex(src, true).at(offset) resolves it on demand.
     // Optional payloads:
     bool hasNumber = false;
+    bool isInteger = false; // integer literal (decimal or 0x/0b/0o) held exactly in numberValue
     double numberValue = 0.0;
     bool immediate = false; // true if number came from #<digits> form
     int regIndex = -1;      // for Register tokens (R7 -> 7)
+
+    std::string_view text(std::string_view src) const {
+        return src.substr(offset, length);
+    }
 };
 
+// ---------- keyword / mode perfect hash ----------
+// Keywords match in any case; mode words are exact (foldCase off). The slot
+// table is built by the compiler (triad_perfect_hash.hpp).
+namespace detail {
+
+inline constexpr phash::Word<TokenType> kWords[] = {
+    // logical
+    {"not", TokenType::KwNot}, {"and", TokenType::KwAnd}, {"or", TokenType::KwOr},
+    // core
+    {"macro", TokenType::KwMacro}, {"end", TokenType::KwEnd}, {"capsule", TokenType::KwCapsule},
+    {"let", TokenType::KwLet}, {"return", TokenType::KwReturn}, {"if", TokenType::KwIf},
+    {"else", TokenType::KwElse}, {"loop", TokenType::KwLoop}, {"jump", TokenType::KwJump},
+    {"from", TokenType::KwFrom}, {"to", TokenType::KwTo},
+    {"say", TokenType::KwSay}, {"echo", TokenType::KwEcho}, {"tone", TokenType::KwTone},
+    {"trace", TokenType::KwTrace}, {"mutate", TokenType::KwMutate},
+    {"load", TokenType::KwLoad}, // accepts both 'load' and 'Load'
+    // types & oop
+    {"struct", TokenType::KwStruct}, {"class", TokenType::KwClass}, {"enum", TokenType::KwEnum},
+    {"func", TokenType::KwFunc}, {"init", TokenType::KwInit}, {"new", TokenType::KwNew}, {"this", TokenType::KwThis},
+    // exceptions
+    {"try", TokenType::KwTry}, {"catch", TokenType::KwCatch}, {"finally", TokenType::KwFinally}, {"throw", TokenType::KwThrow},
+    // modules
+    {"import", TokenType::KwImport}, {"as", TokenType::KwAs}, {"using", TokenType::KwUsing}, {"with", TokenType::KwWith},
+    // literals
+    {"true", TokenType::KwTrue}, {"false", TokenType::KwFalse}, {"null", TokenType::KwNull},
+    // modes: recognized adverbs (extend freely)
+    {"Fastest", TokenType::Mode, false}, {"Softest", TokenType::Mode, false}, {"Hardest", TokenType::Mode, false},
+    {"Brightest", TokenType::Mode, false}, {"Deepest", TokenType::Mode, false},
+    {"Sharpest", TokenType::Mode, false}, {"Quietest", TokenType::Mode, false},
+    {"Deterministic", TokenType::Mode, false}, {"Sandboxed", TokenType::Mode, false},
+    {"Introspective", TokenType::Mode, false}, {"Mutable", TokenType::Mode, false},
+};
+
+inline constexpr phash::Table<TokenType, sizeof(kWords) / sizeof(kWords[0]), 256> kWordTable{kWords};
+static_assert(kWordTable.found(), "no collision-free seed for the keyword table");
+
+} // namespace detail
+
 struct LexError : std::runtime_error {
-    SourcePos pos;
-    explicit LexError(const std::string& msg, SourcePos p)
+    LineCol pos;
+    explicit LexError(const std::string& msg, LineCol p)
         : std::runtime_error(msg), pos(p) {}
 };
 
 class Lexer {
 public:
-    explicit Lexer(std::string src)
-        : m_src(std::move(src)) { m_len = static_cast<int>(m_src.size()); }
+    // The lexer does not copy its input: tokens are windows into `src`,
+    // so the text must outlive both the lexer and every token it returns.
+    explicit Lexer(std::string_view src)
+        : m_src(src) { m_len = static_cast<int>(m_src.size()); }
+
+    // Decode the escapes of a String token's contents (text without the quotes).
+    // readString() has already validated them; \uXXXX is kept raw.
+    static std::string unescape(std::string_view raw) {
+        std::string value;
+        value.reserve(raw.size());
+        for (size_t i = 0; i < raw.size(); ++i) {
+            char c = raw[i];
+            if (c != '\\' || i + 1 >= raw.size()) { value.push_back(c); continue; }
+            switch (raw[++i]) {
+                case '"':  value.push_back('"');  break;
+                case '\\': value.push_back('\\'); break;
+                case 'n':  value.push_back('\n'); break;
+                case 'r':  value.push_back('\r'); break;
+                case 't':  value.push_back('\t'); break;
+                default:   value.push_back('\\'); value.push_back(raw[i]); break; // \uXXXX
+            }
+        }
+        return value;
+    }
 
     std::vector<Token> tokenize() {
         std::vector<Token> out;
@@ -86,62 +156,62 @@ public:
             if (isAtEnd()) break;
 
             const char c = peek();
-            const SourcePos startPos = m_pos;
+            const int startIdx = m_idx;
 
             // EOL or Semicolon → Eol
             if (c == ';') {
                 advance();
-                out.push_back(makeSimple(TokenType::Eol, ";", startPos));
+                out.push_back(makeSimple(TokenType::Eol, startIdx));
                 continue;
             }
 
             // Punctuation
             switch (c) {
-                case '(': out.push_back(makeSimple(TokenType::LParen, consumeChar(), startPos)); continue;
-                case ')': out.push_back(makeSimple(TokenType::RParen, consumeChar(), startPos)); continue;
-                case '{': out.push_back(makeSimple(TokenType::LBrace, consumeChar(), startPos)); continue;
-                case '}': out.push_back(makeSimple(TokenType::RBrace, consumeChar(), startPos)); continue;
-                case '[': out.push_back(makeSimple(TokenType::LBracket, consumeChar(), startPos)); continue;
-                case ']': out.push_back(makeSimple(TokenType::RBracket, consumeChar(), startPos)); continue;
-                case ',': out.push_back(makeSimple(TokenType::Comma, consumeChar(), startPos)); continue;
-                case ':': out.push_back(makeSimple(TokenType::Colon, consumeChar(), startPos)); continue;
-                case '.': out.push_back(makeSimple(TokenType::Dot, consumeChar(), startPos)); continue;
+                case '(': out.push_back(makeSimple(TokenType::LParen, consumeChar())); continue;
+                case ')': out.push_back(makeSimple(TokenType::RParen, consumeChar())); continue;
+                case '{': out.push_back(makeSimple(TokenType::LBrace, consumeChar())); continue;
+                case '}': out.push_back(makeSimple(TokenType::RBrace, consumeChar())); continue;
+                case '[': out.push_back(makeSimple(TokenType::LBracket, consumeChar())); continue;
+                case ']': out.push_back(makeSimple(TokenType::RBracket, consumeChar())); continue;
+                case ',': out.push_back(makeSimple(TokenType::Comma, consumeChar())); continue;
+                case ':': out.push_back(makeSimple(TokenType::Colon, consumeChar())); continue;
+                case '.': out.push_back(makeSimple(TokenType::Dot, consumeChar())); continue;
             }
 
             // Operators (two-char first)
             if (c == '=') {
                 advance();
-                if (match('=')) out.push_back(makeSimple(TokenType::EqualEqual, "==", startPos));
-                else            out.push_back(makeSimple(TokenType::Equal, "=", startPos));
+                if (match('=')) out.push_back(makeSimple(TokenType::EqualEqual, startIdx));
+                else            out.push_back(makeSimple(TokenType::Equal, startIdx));
                 continue;
             }
             if (c == '!') {
                 advance();
-                if (match('=')) out.push_back(makeSimple(TokenType::BangEqual, "!=", startPos));
-                else throw LexError("Unexpected '!'", startPos);
+                if (match('=')) out.push_back(makeSimple(TokenType::BangEqual, startIdx));
+                else throw errorAt("Unexpected '!'", startIdx);
                 continue;
             }
             if (c == '<') {
                 advance();
-                if (match('=')) out.push_back(makeSimple(TokenType::LessEqual, "<=", startPos));
-                else            out.push_back(makeSimple(TokenType::Less, "<", startPos));
+                if (match('=')) out.push_back(makeSimple(TokenType::LessEqual, startIdx));
+                else            out.push_back(makeSimple(TokenType::Less, startIdx));
                 continue;
             }
             if (c == '>') {
                 advance();
-                if (match('=')) out.push_back(makeSimple(TokenType::GreaterEqual, ">=", startPos));
-                else            out.push_back(makeSimple(TokenType::Greater, ">", startPos));
+                if (match('=')) out.push_back(makeSimple(TokenType::GreaterEqual, startIdx));
+                else            out.push_back(makeSimple(TokenType::Greater, startIdx));
                 continue;
             }
-            if (c == '+') { out.push_back(makeSimple(TokenType::Plus,  consumeChar(), startPos)); continue; }
-            if (c == '-') { out.push_back(makeSimple(TokenType::Minus, consumeChar(), startPos)); continue; }
-            if (c == '*') { out.push_back(makeSimple(TokenType::Star,  consumeChar(), startPos)); continue; }
-            if (c == '%') { out.push_back(makeSimple(TokenType::Percent,consumeChar(), startPos)); continue; }
+            if (c == '+') { out.push_back(makeSimple(TokenType::Plus,  consumeChar())); continue; }
+            if (c == '-') { out.push_back(makeSimple(TokenType::Minus, consumeChar())); continue; }
+            if (c == '*') { out.push_back(makeSimple(TokenType::Star,  consumeChar())); continue; }
+            if (c == '%') { out.push_back(makeSimple(TokenType::Percent,consumeChar())); continue; }
 
             // Slash may be division OR start of comment (comments already skipped above)
             if (c == '/') {
                 // At this point it must be division, because comment starts were consumed earlier
-                out.push_back(makeSimple(TokenType::Slash, consumeChar(), startPos));
+                out.push_back(makeSimple(TokenType::Slash, consumeChar()));
                 continue;
             }
 
@@ -156,8 +226,8 @@ public:
                 // we treat '#123' as a number token with immediate=true
                 advance(); // consume '#'
                 if (!std::isdigit(peek()) && !(peek() == '.' && std::isdigit(peekNext())))
-                    throw LexError("Expected number after '#'", startPos);
-                Token num = readNumber(startPos);
+                    throw errorAt("Expected number after '#'", startIdx);
+                Token num = readNumber(startIdx);
                 num.immediate = true;
                 out.push_back(std::move(num));
                 continue;
@@ -165,20 +235,20 @@ public:
 
             // Number (regular)
             if (std::isdigit(c) || (c == '.' && std::isdigit(peekNext()))) {
-                out.push_back(readNumber(startPos));
+                out.push_back(readNumber(startIdx));
                 continue;
             }
 
             // Register: R + digits (R0..R15...)
             if ((c == 'R') && std::isdigit(peekNext())) {
-                Token reg = readRegister(startPos);
+                Token reg = readRegister();
                 out.push_back(std::move(reg));
                 continue;
             }
 
             // Identifier / keyword / mode
             if (isIdentStart(c)) {
-                out.push_back(readIdentOrKeyword(startPos));
+                out.push_back(readIdentOrKeyword());
                 continue;
             }
 
@@ -191,19 +261,18 @@ public:
             // Unknown char
             std::ostringstream oss;
             oss << "Unexpected character: '" << c << "'";
-            throw LexError(oss.str(), startPos);
+            throw errorAt(oss.str(), startIdx);
         }
 
         // ensure trailing Eof
-        out.push_back(makeSimple(TokenType::Eof, "", m_pos));
+        out.push_back(makeSimple(TokenType::Eof, m_idx));
         return out;
     }
 
 private:
-    std::string m_src;
+    std::string_view m_src;
     int m_len = 0;
     int m_idx = 0;
-    SourcePos m_pos{1,1};
 
     // ---------- utilities ----------
     bool isAtEnd() const { return m_idx >= m_len; }
@@ -212,46 +281,41 @@ private:
 
     char advance() {
         if (isAtEnd()) return '\0';
-        char c = m_src[m_idx++];
-        if (c == '\r') {
-            // normalize CRLF and CR into LF handling in consumeNewline()
-            if (peek() == '\n') ; // consume in consumeNewline
-            // do not bump line/col here
-        } else if (c == '\n') {
-            // handled in consumeNewline
-        } else {
-            m_pos.column++;
-        }
-        return c;
+        return m_src[m_idx++];
     }
 
-    std::string consumeChar() { char c = advance(); return std::string(1, c); }
+    void advanceRun(const char* to) { m_idx = static_cast<int>(to - m_src.data()); }
+    const char* cursor() const { return m_src.data() + m_idx; }
+    const char* limit() const { return m_src.data() + m_len; }
+
+    // Consume one character and return its offset (for single-char tokens).
+    int consumeChar() { int at = m_idx; advance(); return at; }
 
     static bool isNewline(char c) { return c == '\n' || c == '\r'; }
 
     static bool isIdentStart(char c) {
         return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
     }
-    static bool isIdentCont(char c) {
-        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
-    }
 
     bool match(char expected) {
         if (isAtEnd() || m_src[m_idx] != expected) return false;
         m_idx++;
-        m_pos.column++;
         return true;
     }
 
-    Token makeSimple(TokenType t, const std::string& lex, SourcePos at) {
+    // Token spanning [startIdx, m_idx).
+    Token makeSimple(TokenType t, int startIdx) const {
         Token tok;
         tok.type = t;
-        tok.lexeme = lex;
-        tok.pos = at;
+        tok.offset = static_cast<uint32_t>(startIdx);
+        tok.length = static_cast<uint32_t>(m_idx - startIdx);
         return tok;
     }
-    Token makeSimple(TokenType t, const char* lex, SourcePos at) {
-        return makeSimple(t, std::string(lex), at);
+
+    // Diagnostics are the only consumer of line/column, so the position is
+    // worked out here rather than tracked per character.
+    LexError errorAt(const std::string& msg, int at) const {
+        return LexError(msg, LineIndex(m_src, /*loneCr=*/true).at(static_cast<uint32_t>(at)));
     }
 
     // ---------- whitespace, comments, and line continuation ----------
@@ -259,8 +323,8 @@ private:
         for (;;) {
             // skip spaces & tabs
             while (!isAtEnd()) {
+                advanceRun(scan::skip_blanks(cursor(), limit()));
                 char c = peek();
-                if (c == ' ' || c == '\t') { advance(); continue; }
                 // line continuation: backslash then newline => skip both, no Eol
                 if (c == '\\' && (peekNext() == '\n' || peekNext() == '\r')) {
                     advance(); // backslash
@@ -275,14 +339,14 @@ private:
             // Comments?
             // 1) '#' to end of line
             if (peek() == '#') {
-                while (!isAtEnd() && !isNewline(peek())) advance();
+                advanceRun(scan::find_either(cursor(), limit(), '\n', '\r'));
                 // do not emit Eol yet; let outer loop handle newline
                 continue;
             }
             // 2) '//' to end of line
             if (peek() == '/' && peekNext() == '/') {
                 advance(); advance();
-                while (!isAtEnd() && !isNewline(peek())) advance();
+                advanceRun(scan::find_either(cursor(), limit(), '\n', '\r'));
                 continue;
             }
             // 3) '/* ... */' with nesting
@@ -304,20 +368,16 @@ private:
     }
 
     void consumeNewline(bool emitEol, std::vector<Token>& out) {
-        SourcePos at = m_pos;
-        // Normalize CRLF / CR / LF: consume '\r' optionally then '\n' optionally, bump line once
+        int startIdx = m_idx;
+        // CRLF / CR / LF each end one line
         if (peek() == '\r') {
             advance(); // '\r'
             if (peek() == '\n') advance(); // '\n'
         } else if (peek() == '\n') {
             advance();
         }
-        // move to next line
-        m_pos.line++;
-        m_pos.column = 1;
-
         if (emitEol)
-            out.push_back(makeSimple(TokenType::Eol, "\\n", at));
+            out.push_back(makeSimple(TokenType::Eol, startIdx));
     }
 
     void consumeNewline(std::vector<Token>& out) { consumeNewline(true, out); }
@@ -332,294 +392,122 @@ private:
                 advance(); advance(); // '*/'
                 depth--;
             } else if (isNewline(peek())) {
-                // bump line/col accurately
-                // reuse dummy vector to advance line
                 std::vector<Token> dummy;
                 consumeNewline(false, dummy);
             } else {
                 advance();
+                advanceRun(scan::find_any(cursor(), limit(), '/', '*', '\n', '\r'));
             }
         }
-        if (depth != 0) throw LexError("Unterminated block comment", m_pos);
+        if (depth != 0) throw errorAt("Unterminated block comment", m_idx);
     }
 
     // ---------- strings ----------
+    // Validates the literal; the token covers it verbatim, quotes included.
+    // Decoding is left to unescape() so plain strings never allocate here.
     Token readString() {
-        SourcePos startPos = m_pos;
-        std::string value;
+        int startIdx = m_idx;
+        bool closed = false;
         advance(); // consume opening '"'
 
         while (!isAtEnd()) {
             char c = peek();
-            if (c == '"') { advance(); break; }
-            if (isNewline(c)) throw LexError("Unterminated string literal", startPos);
+            if (c == '"') { advance(); closed = true; break; }
+            if (isNewline(c)) throw errorAt("Unterminated string literal", startIdx);
             if (c == '\\') {
                 advance(); // '\'
                 char esc = peek();
-                if (isAtEnd()) throw LexError("Unterminated string escape", startPos);
+                if (isAtEnd()) throw errorAt("Unterminated string escape", startIdx);
                 switch (esc) {
-                    case '"': value.push_back('"');  advance(); break;
-                    case '\\':value.push_back('\\'); advance(); break;
-                    case 'n': value.push_back('\n'); advance(); break;
-                    case 'r': value.push_back('\r'); advance(); break;
-                    case 't': value.push_back('\t'); advance(); break;
+                    case '"': case '\\': case 'n': case 'r': case 't':
+                        advance();
+                        break;
                     case 'u': {
-                        // \uXXXX
+                        // \uXXXX (kept raw by unescape)
                         advance();
-                        std::string hex;
                         for (int i = 0; i < 4; ++i) {
-                            char h = peek();
-                            if (!std::isxdigit(static_cast<unsigned char>(h)))
-                                throw LexError("Invalid \\u escape (expected 4 hex digits)", m_pos);
-                            hex.push_back(h);
+                            if (!std::isxdigit(static_cast<unsigned char>(peek())))
+                                throw errorAt("Invalid \\u escape (expected 4 hex digits)", m_idx);
                             advance();
                         }
-                        // We keep raw \uXXXX in value (or you can decode to UTF-8 if desired)
-                        value += "\\u" + hex;
                         break;
                     }
                     default:
-                        throw LexError("Unknown string escape", m_pos);
+                        throw errorAt("Unknown string escape", m_idx);
                 }
             } else {
-                value.push_back(c);
-                advance();
+                advanceRun(scan::find_any(cursor(), limit(), '"', '\\', '\n', '\r'));
             }
         }
+        if (!closed) throw errorAt("Unterminated string literal", startIdx);
 
-        Token t;
-        t.type = TokenType::String;
-        t.lexeme = "\"" + value + "\""; // original-like (not exact if we normalized)
-        t.pos = startPos;
-        t.hasNumber = false;
-        t.immediate = false;
-        t.numberValue = 0.0;
-        return t;
+        return makeSimple(TokenType::String, startIdx);
     }
 
     // ---------- numbers ----------
-    Token readNumber(SourcePos startPos) {
-        // Supports:
-        //  - Decimal integers and floats: 123, 3.14, .5, 1e9
-        //  - Hex: 0xFF
-        //  - Bin: 0b1010
-        //  - Oct: 0o755
-        //
-        // We parse into double; downstream can cast as needed.
-
-        std::string s;
-        int startIdx = m_idx;
-
-        // handle prefixes
-        if (peek() == '0' && (peekNext() == 'x' || peekNext() == 'X')) {
-            // hex
-            s.push_back(advance()); // 0
-            s.push_back(advance()); // x
-            if (!std::isxdigit(static_cast<unsigned char>(peek())))
-                throw LexError("Expected hex digits after 0x", startPos);
-            while (std::isxdigit(static_cast<unsigned char>(peek()))) s.push_back(advance());
-            return makeNumberTokenFromBase(startPos, s, 16);
-        }
-        if (peek() == '0' && (peekNext() == 'b' || peekNext() == 'B')) {
-            s.push_back(advance()); s.push_back(advance()); // 0b
-            if (!(peek()=='0' || peek()=='1'))
-                throw LexError("Expected binary digits after 0b", startPos);
-            while (peek()=='0' || peek()=='1') s.push_back(advance());
-            return makeNumberTokenFromBase(startPos, s, 2);
-        }
-        if (peek() == '0' && (peekNext() == 'o' || peekNext() == 'O')) {
-            s.push_back(advance()); s.push_back(advance()); // 0o
-            if (!(peek()>='0' && peek()<='7'))
-                throw LexError("Expected octal digits after 0o", startPos);
-            while (peek()>='0' && peek()<='7') s.push_back(advance());
-            return makeNumberTokenFromBase(startPos, s, 8);
-        }
-
-        // decimal/float
-        bool sawDigit = false;
-        auto appendDigits = [&](bool requireOne) {
-            int count = 0;
-            while (std::isdigit(static_cast<unsigned char>(peek()))) {
-                s.push_back(advance());
-                count++;
-            }
-            if (requireOne && count == 0) throw LexError("Expected digits", startPos);
-            if (count > 0) sawDigit = true;
-        };
-
-        // integer part or leading dot
-        if (peek() == '.') {
-            s.push_back(advance()); // '.'
-            appendDigits(true);     // must have digits after dot: .5
-        } else {
-            appendDigits(true);     // 123
-            // fractional?
-            if (peek() == '.' && std::isdigit(static_cast<unsigned char>(peekNext()))) {
-                s.push_back(advance()); // '.'
-                appendDigits(true);
-            }
-        }
-
-        // exponent?
-        if (peek() == 'e' || peek() == 'E') {
-            s.push_back(advance());
-            if (peek() == '+' || peek() == '-') s.push_back(advance());
-            appendDigits(true);
-        }
-
-        Token t;
-        t.type = TokenType::Number;
-        t.lexeme = m_src.substr(startIdx, m_idx - startIdx);
-        t.pos = startPos;
+    // Decimal, float, exponent and 0x/0b/0o literals (triad_number.hpp);
+    // integer literals are also flagged isInteger. `at` is where errors are
+    // reported: the '#' of an immediate.
+    Token readNumber(int at) {
+        const int startIdx = m_idx;
+        const NumberLiteral lit = scan_number(cursor(), limit());
+        advanceRun(cursor() + lit.len);
+        if (!lit.ok) throw errorAt(numberError(m_src.substr(startIdx, lit.len)), at);
+
+        Token t = makeSimple(TokenType::Number, startIdx);
         t.hasNumber = true;
-        t.numberValue = strToDoubleStrict(s, startPos);
-        t.immediate = false;
+        t.isInteger = lit.integral;
+        t.numberValue = lit.value;
         return t;
     }
 
-    static double strToDoubleStrict(const std::string& s, SourcePos at) {
-        // simple robust parse
-        char* end = nullptr;
-        errno = 0;
-        double v = std::strtod(s.c_str(), &end);
-        if (end == s.c_str() || *end != '\0' || errno == ERANGE) {
-            std::ostringstream oss;
-            oss << "Invalid numeric literal: " << s;
-            throw LexError(oss.str(), at);
-        }
-        return v;
-    }
-
-    Token makeNumberTokenFromBase(SourcePos startPos, const std::string& lexeme, int base) {
-        // lexeme includes prefix (0x/0b/0o); strip it for conversion
-        std::string body = lexeme.substr(2);
-        unsigned long long acc = 0ULL;
-        for (char c : body) {
-            int val;
-            if (std::isdigit(static_cast<unsigned char>(c))) val = c - '0';
-            else if (std::isxdigit(static_cast<unsigned char>(c))) {
-                val = (std::tolower(static_cast<unsigned char>(c)) - 'a') + 10;
-            } else {
-                throw LexError("Invalid digit in literal", startPos);
+    // Why scan_number() turned down `text`, the part of the literal it read.
+    static std::string numberError(std::string_view text) {
+        if (text.size() >= 2 && text[0] == '0') {
+            const char* digits = nullptr;
+            switch (text[1]) {
+                case 'x': case 'X': digits = "Expected hex digits after 0x"; break;
+                case 'b': case 'B': digits = "Expected binary digits after 0b"; break;
+                case 'o': case 'O': digits = "Expected octal digits after 0o"; break;
+                default: break;
             }
-            if (val >= base) throw LexError("Digit out of range for base", startPos);
-            // overflow-safe-ish accumulate
-            unsigned long long prev = acc;
-            acc = acc * base + static_cast<unsigned long long>(val);
-            if (acc < prev) throw LexError("Integer literal overflow", startPos);
+            if (digits) return text.size() == 2 ? digits : "Integer literal overflow";
         }
-        Token t;
-        t.type = TokenType::Number;
-        t.lexeme = lexeme;
-        t.pos = startPos;
-        t.hasNumber = true;
-        t.numberValue = static_cast<double>(acc);
-        t.immediate = false;
-        return t;
+        const char last = text.empty() ? '\0' : text.back();
+        if (last == 'e' || last == 'E' || last == '+' || last == '-') return "Expected digits"; // exponent
+        return "Invalid numeric literal: " + std::string(text);
     }
 
     // ---------- register ----------
-    Token readRegister(SourcePos startPos) {
+    Token readRegister() {
         // We know current is 'R' and next is digit.
         int start = m_idx;
-        std::string s;
-        s.push_back(advance()); // 'R'
-        while (std::isdigit(static_cast<unsigned char>(peek()))) {
-            s.push_back(advance());
-        }
-        // parse index
+        advance(); // 'R'
         int idx = 0;
-        try {
-            idx = std::stoi(s.substr(1));
-        } catch (...) {
-            throw LexError("Invalid register index", startPos);
+        while (std::isdigit(static_cast<unsigned char>(peek()))) {
+            int d = advance() - '0';
+            if (idx > (std::numeric_limits<int>::max() - d) / 10)
+                throw errorAt("Invalid register index", start);
+            idx = idx * 10 + d;
         }
-        Token t;
-        t.type = TokenType::Register;
-        t.lexeme = s;
-        t.pos = startPos;
+        Token t = makeSimple(TokenType::Register, start);
         t.regIndex = idx;
         return t;
     }
 
     // ---------- identifiers / keywords / modes ----------
-    Token readIdentOrKeyword(SourcePos startPos) {
-        std::string s;
-        while (!isAtEnd() && isIdentCont(peek())) s.push_back(advance());
-
-        // Keyword map (lowercased for case-insensitive acceptance where desired)
-        std::string lower = toLower(s);
-        if (auto it = keywordMap().find(lower); it != keywordMap().end()) {
-            // Special case: accept both 'load' and 'Load'
-            Token t;
-            t.type = it->second;
-            t.lexeme = s;
-            t.pos = startPos;
-            return t;
-        }
-
-        // Modes set
-        if (isModeWord(s)) {
-            Token t;
-            t.type = TokenType::Mode;
-            t.lexeme = s;
-            t.pos = startPos;
-            return t;
-        }
-
-        // Register-like names are already handled in readRegister
-        // Fall back to Identifier
-        Token t;
-        t.type = TokenType::Identifier;
-        t.lexeme = s;
-        t.pos = startPos;
-        return t;
-    }
-
-    static std::string toLower(const std::string& s) {
-        std::string r; r.reserve(s.size());
-        for (char c : s) r.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
-        return r;
-    }
-
-    static const std::unordered_map<std::string, TokenType>& keywordMap() {
-        static const std::unordered_map<std::string, TokenType> m = {
-            // logical
-            {"not", TokenType::KwNot}, {"and", TokenType::KwAnd}, {"or", TokenType::KwOr},
-            // core
-            {"macro", TokenType::KwMacro}, {"end", TokenType::KwEnd}, {"capsule", TokenType::KwCapsule},
-            {"let", TokenType::KwLet}, {"return", TokenType::KwReturn}, {"if", TokenType::KwIf},
-            {"else", TokenType::KwElse}, {"loop", TokenType::KwLoop}, {"jump", TokenType::KwJump},
-            {"from", TokenType::KwFrom}, {"to", TokenType::KwTo},
-            {"say", TokenType::KwSay}, {"echo", TokenType::KwEcho}, {"tone", TokenType::KwTone},
-            {"trace", TokenType::KwTrace}, {"mutate", TokenType::KwMutate},
-            {"load", TokenType::KwLoad}, // accepts both 'load' and 'Load' via toLower
-            // types & oop
-            {"struct", TokenType::KwStruct}, {"class", TokenType::KwClass}, {"enum", TokenType::KwEnum},
-            {"func", TokenType::KwFunc}, {"init", TokenType::KwInit}, {"new", TokenType::KwNew}, {"this", TokenType::KwThis},
-            // exceptions
-            {"try", TokenType::KwTry}, {"catch", TokenType::KwCatch}, {"finally", TokenType::KwFinally}, {"throw", TokenType::KwThrow},
-            // modules
-            {"import", TokenType::KwImport}, {"as", TokenType::KwAs}, {"using", TokenType::KwUsing}, {"with", TokenType::KwWith},
-            // literals
-            {"true", TokenType::KwTrue}, {"false", TokenType::KwFalse}, {"null", TokenType::KwNull},
-        };
-        return m;
-    }
+    Token readIdentOrKeyword() {
+        int startIdx = m_idx;
+        advanceRun(scan::skip_ident(cursor(), limit()));
+        std::string_view s = m_src.substr(startIdx, m_idx - startIdx);
 
-    static bool isModeWord(const std::string& s) {
-        // Recognized adverbs (extend freely)
-        static const char* MODES[] = {
-            "Fastest","Softest","Hardest","Brightest","Deepest",
-            "Sharpest","Quietest",
-            "Deterministic","Sandboxed","Introspective","Mutable"
-        };
-        for (auto* w : MODES) if (s == w) return true;
-        return false;
+        // Keywords (any case, so both 'load' and 'Load'), then modes, else
+        // Identifier. Register-like names are already handled in readRegister.
+        return makeSimple(detail::kWordTable.find(s, TokenType::Identifier), startIdx);
     }
 };
 
-} // namespace triad
+} // namespace triad::mini
 
 /*
 Usage example:
@@ -662,17 +550,19 @@ int main() {
         end
     )";
 
-    triad::Lexer lx(src);
+    triad::mini::Lexer lx(src);
     try {
         auto toks = lx.tokenize();
+        triad::LineIndex lines(src, true);
         for (auto& t : toks) {
-            std::cout << (int)t.type << "  \"" << t.lexeme << "\"  (" << t.pos.line << ":" << t.pos.column << ")";
+            triad::LineCol at = lines.at(t.offset);
+            std::cout << (int)t.type << "  \"" << t.text(src) << "\"  (" << at.line << ":" << at.col << ")";
             if (t.hasNumber) std::cout << "  num=" << t.numberValue << (t.immediate ? " (imm)" : "");
-            if (t.type == triad::TokenType::Register) std::cout << "  R=" << t.regIndex;
+            if (t.type == triad::mini::TokenType::Register) std::cout << "  R=" << t.regIndex;
             std::cout << "\n";
         }
-    } catch (const triad::LexError& e) {
-        std::cerr << "Lex error at " << e.pos.line << ":" << e.pos.column << " -> " << e.what() << "\n";
+    } catch (const triad::mini::LexError& e) {
+        std::cerr << "Lex error at " << e.pos.line << ":" << e.pos.col << " -> " << e.what() << "\n";
     }
 }
 */
@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <variant>
@@ -11,12 +12,13 @@
 #include <stdexcept>
 #include <cmath>
 #include "triad_lexer.hpp"   // from previous message
+#include "triad-pro/src/triad_number.hpp"
+#include "triad-pro/src/triad_pratt.hpp"
+#include "triad-pro/src/triad_output.hpp"
 
-using triad::Lexer;
-using triad::Token;
-using triad::TokenType;
-using triad::SourcePos;
-using triad::LexError;
+// Everything but the demo main lives in triad::mini, with the lexer, so it
+// can be linked next to triad-pro's front end (triad-pro/bench does).
+namespace triad::mini {
 
 // ---------- Values ----------
 struct Value {
@@ -50,7 +52,7 @@ struct Value {
     std::string toString() const {
         if (isNull()) return "null";
         if (isBool()) return std::get<bool>(v) ? "true" : "false";
-        if (isNum())  { char buf[64]; std::snprintf(buf,64,"%.15g", std::get<double>(v)); return buf; }
+        if (isNum())  return triad::number_to_string(std::get<double>(v)); // shortest round trip
         return std::get<std::string>(v);
     }
 };
@@ -85,10 +87,19 @@ struct E_Unary : Expr {
     Value eval(struct Context& cx) override;
 };
 
-struct E_Binary : Expr {
+// Left-associative chains (a + b + c + ...) nest on the lhs as deep as they
+// are long, so eval and the destructor follow that spine in a loop.
+struct E_Binary final : Expr {
     std::string op; ExprPtr lhs, rhs;
     E_Binary(ExprPtr a, std::string o, ExprPtr b): op(std::move(o)), lhs(std::move(a)), rhs(std::move(b)) {}
+    ~E_Binary() override {
+        while (auto* l = dynamic_cast<E_Binary*>(lhs.get())) {
+            ExprPtr next = std::move(l->lhs);
+            lhs = std::move(next);
+        }
+    }
     Value eval(struct Context& cx) override;
+    Value apply(Value A, struct Context& cx); // this op with A as the evaluated lhs
 };
 
 struct E_Call : Expr {
@@ -233,6 +244,12 @@ struct Context {
     bool hasReturn=false;
     Value returnValue;
 
+    // Triad calls recurse on the native stack; deeper than this is an error.
+    size_t maxCallDepth = 2000;
+
+    // scratch for E_Binary::eval, used as a stack by nested evaluations
+    std::vector<E_Binary*> spine;
+
     // helpers
     Value getVar(const std::string& n) {
         for (auto it = callStack.rbegin(); it != callStack.rend(); ++it) {
@@ -270,7 +287,30 @@ Value E_Unary::eval(Context& cx) {
 static int cmp(double a, double b){ if (a<b) return -1; if (a>b) return 1; return 0; }
 
 Value E_Binary::eval(Context& cx) {
-    Value A = lhs->eval(cx);
+    const size_t base = cx.spine.size();
+    E_Binary* b = this;
+    for (;;) {
+        cx.spine.push_back(b);
+        auto* l = dynamic_cast<E_Binary*>(b->lhs.get());
+        if (!l) break;
+        b = l;
+    }
+    Value A;
+    try {
+        A = b->lhs->eval(cx);
+        while (cx.spine.size() > base) {
+            E_Binary* n = cx.spine.back();
+            cx.spine.pop_back();
+            A = n->apply(std::move(A), cx);
+        }
+    } catch (...) {
+        cx.spine.resize(base);
+        throw;
+    }
+    return A;
+}
+
+Value E_Binary::apply(Value A, Context& cx) {
     // short-circuit
     if (op=="and") { return Value::Bool(A.asBool() && rhs->eval(cx).asBool()); }
     if (op=="or")  { return Value::Bool(A.asBool() || rhs->eval(cx).asBool()); }
@@ -303,12 +343,14 @@ Value E_Call::eval(Context& cx) {
     auto it = cx.functions.find(name);
     if (it==cx.functions.end()) {
         // builtins callable as functions too
-        if (name=="say" && args.size()==1) { Value v=args[0]->eval(cx); std::cout<<v.toString()<<std::endl; return Value::Null(); }
-        if (name=="echo"&& args.size()==1) { Value v=args[0]->eval(cx); std::cerr<<v.toString()<<std::endl; return Value::Null(); }
+        if (name=="say" && args.size()==1) { Value v=args[0]->eval(cx); say_stream().write_line(v.toString()); return Value::Null(); }
+        if (name=="echo"&& args.size()==1) { Value v=args[0]->eval(cx); echo_stream().write_line(v.toString()); return Value::Null(); }
         throw std::runtime_error("Unknown function: "+name);
     }
     const Function& fn = it->second;
     if (fn.params.size()!=args.size()) throw std::runtime_error("Arity mismatch in call to "+name);
+    if (cx.callStack.size() >= cx.maxCallDepth)
+        throw std::runtime_error("Call depth exceeded "+std::to_string(cx.maxCallDepth)+" in call to "+name);
 
     cx.callStack.push_back({});
     for (size_t i=0;i<args.size();++i){
@@ -326,18 +368,20 @@ Value E_Call::eval(Context& cx) {
     }
     Value rv = cx.returnValue;
     cx.callStack.pop_back();
+    cx.hasReturn=false; // the return ended this call, not the caller
     return rv;
 }
 
 // ---------- Stmt impl ----------
 void S_Let::exec(Context& cx) { cx.setVar(name, expr->eval(cx)); }
 
-void S_Say::exec(Context& cx) { std::cout << e->eval(cx).toString() << std::endl; }
-void S_Echo::exec(Context& cx){ std::cerr << e->eval(cx).toString() << std::endl; }
+// say/echo output is buffered per thread (triad_output.hpp); runCapsule
+// writes it out before returning.
+void S_Say::exec(Context& cx) { say_stream().write_line(e->eval(cx).toString()); }
+void S_Echo::exec(Context& cx){ echo_stream().write_line(e->eval(cx).toString()); }
 
 void S_Tone::exec(Context& cx){
-    std::cout << "[tone" << (modeOpt.empty()?"":(":"+modeOpt)) << "] "
-              << e->eval(cx).toString() << std::endl;
+    say_stream().write_line("[tone" + (modeOpt.empty()?"":(":"+modeOpt)) + "] " + note->eval(cx).toString());
 }
 
 void S_Load::exec(Context& cx){
@@ -384,6 +428,7 @@ void S_Try::exec(Context& cx){
 }
 
 void S_Trace::exec(Context& cx){
+    flush_output(); // after the say and echo lines before it
     if (what=="capsule" || what=="all") {
         std::cerr << "[trace] vars:\n";
         for (auto& kv: cx.vars) std::cerr<<"  "<<kv.first<<" = "<<kv.second.toString()<<"\n";
@@ -429,9 +474,26 @@ void S_Jump::exec(Context& cx){
 }
 
 // ---------- Parser ----------
+// Binary operators, loosest first; the op text is what E_Binary::eval dispatches on.
+static constexpr triad::pratt::Rule<TokenType, const char*> kBinaryRules[] = {
+    {TokenType::KwOr, 1, "or"},
+    {TokenType::KwAnd, 2, "and"},
+    {TokenType::EqualEqual, 3, "=="}, {TokenType::BangEqual, 3, "!="},
+    {TokenType::Less, 4, "<"}, {TokenType::LessEqual, 4, "<="},
+    {TokenType::Greater, 4, ">"}, {TokenType::GreaterEqual, 4, ">="},
+    {TokenType::Plus, 5, "+"}, {TokenType::Minus, 5, "-"},
+    {TokenType::Star, 6, "*"}, {TokenType::Slash, 6, "/"}, {TokenType::Percent, 6, "%"},
+};
+static constexpr triad::pratt::BindingTable<TokenType, const char*, static_cast<size_t>(TokenType::KwNull) + 1>
+    kBinary{kBinaryRules};
+
 class Parser {
 public:
-    explicit Parser(std::vector<Token> toks): t(std::move(toks)) {}
+    // `src` is the text the tokens were lexed from; they only hold offsets into it.
+    // Blocks, parentheses, argument lists and prefix operators may nest at most
+    // `maxDepth` deep: parsing and evaluation recurse once per level.
+    Parser(std::vector<Token> toks, std::string_view src, int maxDepth = 4096)
+        : t(std::move(toks)), src(src), maxDepth(maxDepth) {}
 
     void parseProgram(std::unordered_map<std::string, Function>& fns,
                       std::unordered_map<std::string, Capsule>& caps) {
@@ -448,7 +510,21 @@ public:
     }
 
 private:
+    template <class Table, class P> friend auto triad::pratt::climb(const Table&, P&, unsigned);
+
     std::vector<Token> t; int i=0;
+    std::string_view src;
+    int depth=0, maxDepth;
+
+    // Held for the extent of one nesting level.
+    struct Nest {
+        Parser& p;
+        explicit Nest(Parser& q): p(q) {
+            if (p.depth >= p.maxDepth) p.error("Nesting deeper than "+std::to_string(p.maxDepth)+" levels");
+            ++p.depth;
+        }
+        ~Nest(){ --p.depth; }
+    };
 
     // --- helpers
     bool isAtEnd()  const { return i >= (int)t.size(); }
@@ -457,11 +533,12 @@ private:
     bool check(TokenType k) const { return !isAtEnd() && t[i].type==k; }
     const Token& advance(){ if (!isAtEnd()) ++i; return prev(); }
     bool match(TokenType k){ if (check(k)){ advance(); return true; } return false; }
+    std::string_view text(const Token& x) const { return x.text(src); }
     void consumeEolOpt(){ while (match(TokenType::Eol)){} }
 
     [[noreturn]] void error(const std::string& m) {
-        SourcePos p = isAtEnd()? prev().pos : peek().pos;
-        throw std::runtime_error("Parse error at "+std::to_string(p.line)+":"+std::to_string(p.column)+" -> "+m);
+        LineCol p = LineIndex(src, /*loneCr=*/true).at((isAtEnd()? prev() : peek()).offset);
+        throw std::runtime_error("Parse error at "+std::to_string(p.line)+":"+std::to_string(p.col)+" -> "+m);
     }
 
     bool isIdent(const Token& x) const {
@@ -471,7 +548,7 @@ private:
     // --- parsing
     std::string parseIdent(const std::string& ctx){
         if (!(peek().type==TokenType::Identifier || peek().type==TokenType::Mode)) error("Expected identifier in "+ctx);
-        std::string s = peek().lexeme; advance(); return s;
+        std::string s(text(peek())); advance(); return s;
     }
 
     // func/macro name(params): block end
@@ -513,9 +590,12 @@ private:
         caps[name] = Capsule{name, std::move(body), introspective, mutableCap};
     }
 
+    // Statements up to the 'end' (or 'else', 'catch', 'finally') closing the block.
     std::vector<StmtPtr> parseBlock(){
+        Nest nest(*this);
         std::vector<StmtPtr> out;
-        while (!check(TokenType::KwEnd) && !check(TokenType::Eof)) {
+        while (!check(TokenType::KwEnd) && !check(TokenType::KwElse) && !check(TokenType::KwCatch) &&
+               !check(TokenType::KwFinally) && !check(TokenType::Eof)) {
             if (check(TokenType::Eol)) { advance(); continue; }
             out.push_back(parseStmt());
         }
@@ -555,7 +635,7 @@ private:
     StmtPtr parseTone(){
         // tone [Mode] "Note"
         std::string mode;
-        if (peek().type==TokenType::Mode) { mode = peek().lexeme; advance(); }
+        if (peek().type==TokenType::Mode) { mode = std::string(text(peek())); advance(); }
         ExprPtr e = parseExpr();
         consumeEolOpt();
         return std::make_unique<S_Tone>(mode, std::move(e));
@@ -582,7 +662,7 @@ private:
         char op = '+';
         if (peek().type==TokenType::Plus || peek().type==TokenType::Minus ||
             peek().type==TokenType::Star || peek().type==TokenType::Slash) {
-            op = peek().lexeme[0]; advance();
+            op = text(peek())[0]; advance();
         }
         if (peek().type!=TokenType::Number) error("Expected number in mutate");
         double amt = peek().numberValue; advance();
@@ -676,65 +756,30 @@ private:
         return std::make_unique<S_Try>(std::move(body), std::move(catchName), std::move(cbody), std::move(fbody));
     }
 
-    // ---------- Expressions (precedence climbing) ----------
-    ExprPtr parseExpr(){ return parseOr(); }
-    ExprPtr parseOr(){
-        ExprPtr e = parseAnd();
-        while (match(TokenType::KwOr)) e = std::make_unique<E_Binary>(std::move(e), "or", parseAnd());
-        return e;
-    }
-    ExprPtr parseAnd(){
-        ExprPtr e = parseEquality();
-        while (match(TokenType::KwAnd)) e = std::make_unique<E_Binary>(std::move(e), "and", parseEquality());
-        return e;
-    }
-    ExprPtr parseEquality(){
-        ExprPtr e = parseRel();
-        while (match(TokenType::EqualEqual) || match(TokenType::BangEqual)) {
-            std::string op = prev().lexeme;
-            e = std::make_unique<E_Binary>(std::move(e), op, parseRel());
-        }
-        return e;
-    }
-    ExprPtr parseRel(){
-        ExprPtr e = parseAdd();
-        while (match(TokenType::Less) || match(TokenType::LessEqual) ||
-               match(TokenType::Greater) || match(TokenType::GreaterEqual)) {
-            std::string op = prev().lexeme;
-            e = std::make_unique<E_Binary>(std::move(e), op, parseAdd());
-        }
-        return e;
-    }
-    ExprPtr parseAdd(){
-        ExprPtr e = parseMul();
-        while (match(TokenType::Plus) || match(TokenType::Minus)) {
-            std::string op = prev().lexeme;
-            e = std::make_unique<E_Binary>(std::move(e), op, parseMul());
-        }
-        return e;
-    }
-    ExprPtr parseMul(){
-        ExprPtr e = parseUnary();
-        while (match(TokenType::Star) || match(TokenType::Slash) || match(TokenType::Percent)) {
-            std::string op = prev().lexeme;
-            e = std::make_unique<E_Binary>(std::move(e), op, parseUnary());
-        }
-        return e;
+    // ---------- Expressions (precedence climbing over kBinary) ----------
+    ExprPtr parseExpr(){ return triad::pratt::climb(kBinary, *this); }
+    TokenType peek_kind() const { return isAtEnd() ? TokenType::Eof : peek().type; }
+    void skip(){ advance(); }
+    ExprPtr operand(){ return parseUnary(); }
+    template <class Rhs> ExprPtr infix(ExprPtr lhs, const char* op, Rhs rhs){
+        return std::make_unique<E_Binary>(std::move(lhs), op, rhs());
     }
     ExprPtr parseUnary(){
         if (match(TokenType::Minus) || match(TokenType::Plus) || match(TokenType::KwNot)) {
-            std::string op = prev().type==TokenType::KwNot ? "not" : prev().lexeme;
+            std::string op = prev().type==TokenType::KwNot ? "not" : std::string(text(prev()));
+            Nest nest(*this);
             return std::make_unique<E_Unary>(op, parseUnary());
         }
         return parsePrimary();
     }
     ExprPtr parsePrimary(){
         if (match(TokenType::Number))  return std::make_unique<E_Literal>(Value::Num(prev().numberValue));
-        if (match(TokenType::String))  return std::make_unique<E_Literal>(Value::Str(prev().lexeme.substr(1, prev().lexeme.size()-2)));
+        if (match(TokenType::String))  return std::make_unique<E_Literal>(Value::Str(Lexer::unescape(text(prev()).substr(1, prev().length-2))));
         if (match(TokenType::KwTrue))  return std::make_unique<E_Literal>(Value::Bool(true));
         if (match(TokenType::KwFalse)) return std::make_unique<E_Literal>(Value::Bool(false));
         if (match(TokenType::KwNull))  return std::make_unique<E_Literal>(Value::Null());
         if (match(TokenType::LParen)) {
+            Nest nest(*this);
             ExprPtr e = parseExpr();
             expect(TokenType::RParen, "Expected ')'");
             return e;
@@ -743,6 +788,7 @@ private:
         if (isIdent(peek())) {
             std::string name = parseIdent("expr");
             if (match(TokenType::LParen)) {
+                Nest nest(*this);
                 std::vector<ExprPtr> args;
                 if (!check(TokenType::RParen)) {
                     do { args.push_back(parseExpr()); } while (match(TokenType::Comma));
@@ -764,17 +810,23 @@ static void runCapsule(Context& cx, const std::string& name){
     auto it = cx.capsules.find(name);
     if (it==cx.capsules.end()) throw std::runtime_error("No capsule named "+name);
     cx.hasReturn=false;
+    struct Flush { ~Flush(){ flush_output(); } } flush;
     try{
         for (auto& s: it->second.body){
             s->exec(cx);
             if (cx.hasReturn) break;
         }
     }catch (TriadException& ex){
+        flush_output();
         std::cerr << "[uncaught] " << ex.payload.toString() << "\n";
     }
 }
 
+} // namespace triad::mini
+
 // ---------- Demo main ----------
+// Define TRIAD_MIN_NO_MAIN to embed the interpreter (triad-pro/bench does).
+#ifndef TRIAD_MIN_NO_MAIN
 static const char* DEMO = R"TRIAD(
 macro sparkle(level):
   let shine = level * 2
@@ -817,20 +869,21 @@ end
 )TRIAD";
 
 int main() {
+    using namespace triad::mini;
     try {
         // 1) Lex
         Lexer lx(DEMO);
         auto toks = lx.tokenize();
 
         // 2) Parse program
-        Parser p(std::move(toks));
+        Parser p(std::move(toks), DEMO);
         Context cx;
         p.parseProgram(cx.functions, cx.capsules);
 
         // 3) Run a capsule
         runCapsule(cx, "AgentMain");
     } catch (const LexError& e) {
-        std::cerr << "Lex error at " << e.pos.line << ":" << e.pos.column << " -> " << e.what() << "\n";
+        std::cerr << "Lex error at " << e.pos.line << ":" << e.pos.col << " -> " << e.what() << "\n";
         return 1;
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << "\n";
@@ -838,3 +891,4 @@ int main() {
     }
     return 0;
 }
+#endif // TRIAD_MIN_NO_MAIN
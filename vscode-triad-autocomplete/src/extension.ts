@@ -93,27 +93,48 @@ function indexOne(doc: vscode.TextDocument): FileIndex {
   return { uri: doc.uri, vars, tupleShapes, pureDefs, inferredShapes };
 }
 
-async function buildWorkspaceIndex(): Promise<WorkspaceIndex> {
-  const byFile = new Map<string, FileIndex>();
-  const varDefs = new Map<string, vscode.Location[]>();
-  const pureDefs = new Map<string, vscode.Location>();
+/** Add one file's entries to the workspace maps */
+function addFile(ws: WorkspaceIndex, idx: FileIndex) {
+  ws.byFile.set(idx.uri.toString(), idx);
+  for (const [v, pos] of idx.vars){
+    const arr = ws.varDefs.get(v) || [];
+    arr.push(new vscode.Location(idx.uri, pos));
+    ws.varDefs.set(v, arr);
+  }
+  for (const [k, pd] of idx.pureDefs){
+    ws.pureDefs.set(k, new vscode.Location(idx.uri, pd.range.start));
+  }
+}
+
+/** Take one file's entries back out; other files keep theirs */
+function removeFile(ws: WorkspaceIndex, key: string) {
+  const old = ws.byFile.get(key);
+  if (!old) return;
+  ws.byFile.delete(key);
+  for (const v of old.vars.keys()){
+    const rest = (ws.varDefs.get(v) || []).filter(l => l.uri.toString() !== key);
+    if (rest.length) ws.varDefs.set(v, rest);
+    else ws.varDefs.delete(v);
+  }
+  for (const k of old.pureDefs.keys()){
+    if (ws.pureDefs.get(k)?.uri.toString() !== key) continue;
+    ws.pureDefs.delete(k);
+    // another file may define the same method
+    for (const idx of ws.byFile.values()){
+      const pd = idx.pureDefs.get(k);
+      if (pd) { ws.pureDefs.set(k, new vscode.Location(idx.uri, pd.range.start)); break; }
+    }
+  }
+}
 
+async function buildWorkspaceIndex(): Promise<WorkspaceIndex> {
+  const ws: WorkspaceIndex = { byFile: new Map(), varDefs: new Map(), pureDefs: new Map() };
   const files = await vscode.workspace.findFiles('**/*.triad');
   for (const uri of files){
     const doc = await vscode.workspace.openTextDocument(uri);
-    const idx = indexOne(doc);
-    byFile.set(uri.toString(), idx);
-    for (const [v, pos] of idx.vars){
-      const arr = varDefs.get(v) || [];
-      arr.push(new vscode.Location(uri, pos));
-      varDefs.set(v, arr);
-    }
-    for (const [k, pd] of idx.pureDefs){
-      pureDefs.set(k, new vscode.Location(uri, pd.range.start));
-    }
+    addFile(ws, indexOne(doc));
   }
-
-  return { byFile, varDefs, pureDefs };
+  return ws;
 }
 
 function currentPrefix(line: string, col: number): string {
@@ -125,24 +146,21 @@ function currentPrefix(line: string, col: number): string {
 export async function activate(ctx: vscode.ExtensionContext) {
   const wsIndex = await buildWorkspaceIndex();
 
-  // Rebuild on save
-  ctx.subscriptions.push(vscode.workspace.onDidSaveTextDocument(async (doc)=>{
+  // Re-index only the edited file, shortly after typing stops, and swap its
+  // entries in the workspace maps; the other files are left alone.
+  const pending = new Map<string, ReturnType<typeof setTimeout>>();
+  const reindex = (doc: vscode.TextDocument) => {
     if (doc.languageId!=='triad') return;
-    const updated = indexOne(doc);
-    wsIndex.byFile.set(doc.uri.toString(), updated);
-    wsIndex.varDefs.clear();
-    wsIndex.pureDefs.clear();
-    for (const [uri, idx] of wsIndex.byFile){
-      for (const [v, pos] of idx.vars){
-        const arr = wsIndex.varDefs.get(v) || [];
-        arr.push(new vscode.Location(vscode.Uri.parse(uri), pos));
-        wsIndex.varDefs.set(v, arr);
-      }
-      for (const [k, pd] of idx.pureDefs){
-        wsIndex.pureDefs.set(k, new vscode.Location(vscode.Uri.parse(uri), pd.range.start));
-      }
-    }
-  }));
+    const key = doc.uri.toString();
+    clearTimeout(pending.get(key));
+    pending.set(key, setTimeout(()=>{
+      pending.delete(key);
+      removeFile(wsIndex, key);
+      addFile(wsIndex, indexOne(doc));
+    }, 250));
+  };
+  ctx.subscriptions.push(vscode.workspace.onDidChangeTextDocument(e => { if (e.contentChanges.length) reindex(e.document); }));
+  ctx.subscriptions.push(vscode.workspace.onDidSaveTextDocument(reindex));
 
   // Completion
   ctx.subscriptions.push(vscode.languages.registerCompletionItemProvider('triad', {